@@ -28,6 +28,158 @@ extern "C" {
     // Caller must free via minijs_free().
     MINIJS_API char* minijs_run(void* it, const char* code);
 
+    // Same as minijs_run, additionally reports the result length (excluding NUL).
+    // String results built via `s += x` (ropes) or the StringBuilder builtin
+    // (append(s), length, toString()) are flattened exactly once, straight into
+    // the returned buffer, so hosts can copy it without another strlen.
+    // (minijspp::Engine::run uses it once setResultLength(true) or the compile
+    // cache is enabled; otherwise it sticks to minijs_run for older libraries.)
+    MINIJS_API char* minijs_run_n(void* it, const char* code, size_t* outLen);
+
+    // Runs code and writes the NUL-terminated result into the caller's buffer.
+    // *outLen always receives the result length (excluding NUL).
+    // Returns 1 if it fit (len < cap). Returns 0 if buf was too small; the
+    // result is then kept so minijs_last_result_into can copy it after the
+    // caller grew its buffer (without running the script again).
+    MINIJS_API int32_t minijs_run_into(void* it, const char* code, char* buf, size_t cap, size_t* outLen);
+    MINIJS_API int32_t minijs_last_result_into(void* it, char* buf, size_t cap, size_t* outLen);
+
+    // Precompiled scripts: compile once, run many times on the same interpreter.
+    // Returns NULL on a syntax error (running the source reports it as usual).
+    // minijs_script_run_n/_into behave like minijs_run_n/minijs_run_into.
+    // Release the script handle via minijs_handle_release before minijs_destroy.
+    MINIJS_API void*   minijs_compile(void* it, const char* code, size_t len);
+    MINIJS_API char*   minijs_script_run_n(void* it, void* script, size_t* outLen);
+    MINIJS_API int32_t minijs_script_run_into(void* it, void* script, char* buf, size_t cap, size_t* outLen);
+
+    // ----------------------------
+    // Fuel metering (deterministic work budget)
+    // ----------------------------
+    // Every interpreter step costs fuel: one unit per evaluated node / native
+    // call, builtins charge per element they touch. Same script + same input
+    // => same consumption, independent of machine speed. The budget applies
+    // to each run separately; consumption restarts at 0 for every minijs_run*.
+    // On exhaustion the run stops cleanly with result "Error: fuel exhausted"
+    // and minijs_last_error reports MINIJS_ERR_FUEL. fuel = 0: unlimited (default).
+    enum minijs_error : int32_t {
+        MINIJS_OK = 0,
+        MINIJS_ERR_SCRIPT = 1,    // uncaught script error / syntax error
+        MINIJS_ERR_FUEL = 2
+    };
+
+    MINIJS_API void     minijs_set_fuel(void* it, uint64_t fuel);
+    MINIJS_API uint64_t minijs_fuel_consumed(void* it);   // of the last/current run (set_fuel keeps it)
+    MINIJS_API int32_t  minijs_last_error(void* it);      // minijs_error of the last run
+
+    // ----------------------------
+    // Per-interpreter accounting (cumulative since create / last reset)
+    // ----------------------------
+#pragma pack(push, 8)
+    typedef struct minijs_engine_stats {
+        uint64_t run_count;
+        uint64_t script_cpu_ns;     // thread CPU time in runs, native callbacks excluded
+        uint64_t native_cpu_ns;     // thread CPU time in native callbacks
+        uint64_t native_calls;
+        uint64_t bytes_allocated;   // total allocated by the script heap
+        uint64_t bytes_live;        // current heap size (not reset)
+        uint64_t gc_count;
+        uint64_t gc_ns;             // time spent collecting
+    } minijs_engine_stats;
+#pragma pack(pop)
+
+    // Counters are atomics: reading from another thread (e.g. a metrics exporter) is safe.
+    MINIJS_API void minijs_get_stats(void* it, minijs_engine_stats* out);
+    MINIJS_API void minijs_reset_stats(void* it);
+
+    // ----------------------------
+    // Garbage collector (generational)
+    // ----------------------------
+    // New objects are bump-allocated in a per-interpreter nursery. When it is
+    // full, a copying minor GC evacuates what is reachable from the roots
+    // (stack, globals, host handles) and from the remembered set (old->young
+    // references recorded by the write barrier); objects that survived
+    // promote_age minor GCs are copied into the old space instead. A minor
+    // pause is proportional to the live young data, not to the heap size.
+    // The old space is marked/swept when it has grown by old_growth_percent
+    // since the previous major GC. Host handles point at cells, not at the
+    // objects, so they (and minijs_handle_identity) survive moves.
+    // minijs_engine_stats.gc_count/gc_ns cover minor + major collections.
+#pragma pack(push, 8)
+    typedef struct minijs_gc_config {
+        uint32_t nursery_bytes;         // 0 = default (1 MiB)
+        uint32_t promote_age;           // minor GCs survived before promotion; 0 = default (1)
+        uint32_t old_growth_percent;    // major GC trigger; 0 = default (100)
+    } minijs_gc_config;
+
+    typedef struct minijs_gc_stats {
+        uint64_t minor_count;
+        uint64_t minor_ns;
+        uint64_t minor_max_pause_ns;
+        uint64_t major_count;
+        uint64_t major_ns;
+        uint64_t major_max_pause_ns;
+        uint64_t bytes_promoted;        // copied nursery -> old space
+        uint64_t bytes_survived;        // copied within the nursery (not yet old enough)
+        uint64_t nursery_bytes;         // configured size (not reset)
+        uint64_t young_live_bytes;      // after the last minor GC (not reset)
+        uint64_t old_live_bytes;        // after the last major GC (not reset)
+        uint64_t remembered_set;        // old->young slots at the last minor GC (not reset)
+    } minijs_gc_stats;
+#pragma pack(pop)
+
+    // Only before the first run; returns 0 (and changes nothing) afterwards.
+    MINIJS_API int32_t minijs_gc_configure(void* it, const minijs_gc_config* cfg);
+    // Same atomics as minijs_get_stats (any thread); minijs_reset_stats resets the counters.
+    MINIJS_API void    minijs_gc_get_stats(void* it, minijs_gc_stats* out);
+    // full = 0: minor GC only, 1: minor + major. Not from inside a run (no-op there).
+    MINIJS_API void    minijs_gc_collect(void* it, int32_t full);
+
+    // ----------------------------
+    // Streaming output (profiles, snapshots)
+    // ----------------------------
+    // Called repeatedly with consecutive chunks; data is only valid during the call.
+    typedef void(*minijs_writer_cb)(const char* data, size_t len, void* userdata);
+
+    // ----------------------------
+    // Allocation profiler (sampling, opt-in)
+    // ----------------------------
+    // Samples on average one allocation per sample_interval_bytes (Poisson
+    // sampling like tcmalloc, so big allocations are always seen) and records
+    // the script stack as "fn (file:line)" frames, scaled back to estimated bytes.
+    // Stop ends sampling and streams one report:
+    // - COLLAPSED:          "outer;inner;leaf <bytes>\n" of all sampled allocations
+    //                       (flamegraph.pl, speedscope)
+    // - COLLAPSED_RETAINED: same, but only samples still alive at stop
+    // - PPROF:              uncompressed pprof protobuf with alloc_objects/alloc_space/
+    //                       inuse_objects/inuse_space (`go tool pprof` reads it)
+    enum minijs_profile_format : int32_t {
+        MINIJS_PROFILE_COLLAPSED = 0,
+        MINIJS_PROFILE_COLLAPSED_RETAINED = 1,
+        MINIJS_PROFILE_PPROF = 2
+    };
+
+    // Returns 0 if a profile is already running.
+    MINIJS_API int32_t minijs_alloc_profile_start(void* it, uint64_t sample_interval_bytes);
+    // Returns 0 if no profile was running (writer is not called).
+    MINIJS_API int32_t minijs_alloc_profile_stop(void* it, int32_t format, minijs_writer_cb writer, void* userdata);
+
+    // ----------------------------
+    // Heap snapshot
+    // ----------------------------
+    // Runs a full GC, then streams the live object graph as UTF-8 lines with
+    // tab-separated fields (format version 1):
+    //   MINIJS-HEAP\t1
+    //   N\t<id>\t<kind>\t<self_bytes>\t<name>     node
+    //   E\t<from>\t<to>\t<edge_kind>\t<label>     edge (from retains to)
+    //   R\t<id>\t<root_kind>                       GC root
+    // kind:      object|array|string|function|closure|class|map|set|task|native|shared
+    // edge_kind: property|element|internal|context|weak (weak edges don't retain)
+    // root_kind: global|stack|handle|shared
+    // ids equal minijs_handle_identity(). All N lines precede all E/R lines.
+    // In name/label, backslash, tab and newline are escaped as \\, \t, \n.
+    // Returns 0 on failure.
+    MINIJS_API int32_t minijs_heap_snapshot(void* it, minijs_writer_cb writer, void* userdata);
+
     // ----------------------------
     // Value transport (ABI-stable)
     // ----------------------------
@@ -40,24 +192,60 @@ extern "C" {
         MINIJS_OBJECT = 5,
         MINIJS_FUNCTION = 6,
         MINIJS_CLASS = 7,
-        MINIJS_TASK = 8
+        MINIJS_TASK = 8,
+        MINIJS_INT = 9,     // small integer, payload in i32 (see minijs_set_int_transport)
+        MINIJS_MAP = 10,
+        MINIJS_SET = 11
     };
 
 #pragma pack(push, 8)
     typedef struct minijs_value {
         int32_t kind;       // minijs_kind
         double  num;        // number payload
-        int32_t boolean;    // bool payload (0/1)
+        union {
+            int32_t boolean;    // bool payload (0/1)
+            int32_t i32;        // MINIJS_INT payload
+        };
         const char* str;    // UTF-8 string payload
-        void* handle;     // opaque handle for Array/Object/Function/Class/Task
+        void* handle;     // opaque handle for Array/Object/Function/Class/Task/Map/Set
     } minijs_value;
 #pragma pack(pop)
 
+    // ----------------------------
+    // Small integers
+    // ----------------------------
+    // The runtime keeps int32 numbers untagged (overflow-checked arithmetic,
+    // falls back to double on overflow) and indexes arrays without a
+    // double round trip. MINIJS_INT is always accepted as input.
+    // Outputs (callback args, array/object get, thisVal) only use MINIJS_INT
+    // after the host opted in; otherwise such values arrive as MINIJS_NUMBER.
+    MINIJS_API void  minijs_set_int_transport(void* it, int32_t enabled);
+
     // ----------------------------
     // Handles (retain/release)
     // ----------------------------
     MINIJS_API void minijs_handle_retain(void* h);
     MINIJS_API void minijs_handle_release(void* h);
+    // Stable identity of the object behind h: equal for every handle to the same
+    // object, never reused while the object is alive. 0 for NULL.
+    MINIJS_API uint64_t minijs_handle_identity(void* h);
+
+    // ----------------------------
+    // Weak handles / finalization
+    // ----------------------------
+    // A weak handle does not keep its target alive. minijs_weak_get returns a new
+    // strong (retained) handle, or NULL once the target has been collected.
+    MINIJS_API void* minijs_weak_create(void* h);
+    MINIJS_API void* minijs_weak_get(void* weak);
+    MINIJS_API void  minijs_weak_release(void* weak);
+
+    // cb(userdata) runs exactly once: after h's object is collected, or at the
+    // latest from minijs_destroy of its interpreter. Runs on the interpreter
+    // thread, outside script execution; it must not touch the collected object.
+    // Registrations stack: calling it again on the same object adds another
+    // finalizer (each cb/userdata pair runs once, newest first); none is replaced.
+    typedef void(*minijs_finalizer_cb)(void* userdata);
+    MINIJS_API void  minijs_set_finalizer(void* h, minijs_finalizer_cb cb, void* userdata);
 
     // ----------------------------
     // Native callbacks
@@ -72,6 +260,29 @@ extern "C" {
     // Register native global function: name(...).
     MINIJS_API void  minijs_register(void* it, const char* name, minijs_native_cb cb, void* userdata);
 
+    // Bulk registration: installs `count` natives as methods of the global
+    // namespace object `name` (created if missing) in one call. Names are copied.
+    // With lazy != 0 the function objects are only materialized on first access
+    // of each property, so unused natives cost one table slot.
+    typedef struct minijs_native_entry {
+        const char* name;
+        minijs_native_cb cb;
+        void* userdata;
+    } minijs_native_entry;
+
+    MINIJS_API void  minijs_register_module(void* it, const char* name, const minijs_native_entry* entries, int32_t count, int32_t lazy);
+
+    // Register a pure numeric native: fn is really double(*)(double, ...) taking
+    // exactly `arity` (0..4) doubles. When the first `arity` arguments are all
+    // numbers the runtime calls fn directly (no minijs_value marshaling);
+    // otherwise it calls fallback(argc, argv, thisVal, userdata) as for minijs_register.
+    typedef void(*minijs_fast_fn)(void);
+    MINIJS_API void  minijs_register_fast_f64(void* it, const char* name, minijs_fast_fn fn, int32_t arity,
+        minijs_native_cb fallback, void* userdata);
+    // Direct fn calls of the fast native registered as name (fallback calls not
+    // included). Relaxed atomic counter: readable from any thread. 0 if unknown.
+    MINIJS_API uint64_t minijs_fast_calls(void* it, const char* name);
+
     // Create native function as handle (for methods, storing in objects, etc.)
     MINIJS_API void* minijs_function_create_native(minijs_native_cb cb, void* userdata);
 
@@ -80,6 +291,24 @@ extern "C" {
     // - Does NOT free strings (caller keeps ownership of v->str).
     MINIJS_API void  minijs_global_declare(void* it, const char* name, const minijs_value* v);
 
+    // ----------------------------
+    // Frozen / shared immutable values
+    // ----------------------------
+    // Recursively Object.freeze()s an object/array graph in place.
+    MINIJS_API void  minijs_freeze_deep(void* handle);
+
+    // Deep-copies v's graph once into a process-wide immutable region and returns
+    // a shared handle (atomic refcount, any thread). Does NOT consume v.
+    // minijs_shared_declare binds it into an interpreter by reference: no copy,
+    // reads take no locks, writes throw TypeError. The declare does not consume
+    // the shared handle; the region lives until the last interpreter and the
+    // last shared handle are gone.
+    MINIJS_API void*  minijs_shared_create(const minijs_value* v);
+    MINIJS_API void   minijs_shared_retain(void* shared);
+    MINIJS_API void   minijs_shared_release(void* shared);
+    MINIJS_API void   minijs_shared_declare(void* it, const char* name, void* shared);
+    MINIJS_API size_t minijs_shared_bytes(void* shared);
+
     // ----------------------------
     // Class API (register classes + methods)
     // ----------------------------
@@ -97,6 +326,40 @@ extern "C" {
     MINIJS_API void    minijs_array_set(void* arrHandle, int32_t index, const minijs_value* v);
     MINIJS_API void    minijs_array_push(void* arrHandle, const minijs_value* v);
 
+    // Element kinds: arrays start packed INT32 and move INT32 -> DOUBLE -> GENERIC
+    // on the first write that doesn't fit the current storage (never back).
+    // Packed kinds are contiguous unboxed int32_t/double buffers.
+    enum minijs_elements_kind : int32_t {
+        MINIJS_ELEMENTS_INT32 = 0,
+        MINIJS_ELEMENTS_DOUBLE = 1,
+        MINIJS_ELEMENTS_GENERIC = 2
+    };
+
+    MINIJS_API int32_t minijs_array_elements_kind(void* arrHandle); // minijs_elements_kind (debug/stats)
+    MINIJS_API void    minijs_array_reserve(void* arrHandle, int32_t capacity);
+    // Bulk numeric access (memcpy into/out of packed storage where possible).
+    MINIJS_API void    minijs_array_push_numbers(void* arrHandle, const double* values, int32_t count);
+    // Copies up to count numbers starting at start; stops at the first non-number.
+    // Returns the number of elements written to out.
+    MINIJS_API int32_t minijs_array_get_numbers(void* arrHandle, int32_t start, double* out, int32_t count);
+
+    // Native numeric kernels (scalar/SSE2/AVX2, picked once from CPU features).
+    // Scripts hit the same kernels through reduce/indexOf/fill and the
+    // sum/min/max/dot array builtins whenever the array is packed INT32/DOUBLE.
+    // The reduce/dot calls return 0 (and leave *out untouched) for GENERIC arrays.
+    enum minijs_reduce_op : int32_t {
+        MINIJS_REDUCE_SUM = 0,
+        MINIJS_REDUCE_MIN = 1,
+        MINIJS_REDUCE_MAX = 2
+    };
+
+    MINIJS_API int32_t minijs_array_reduce_numbers(void* arrHandle, int32_t op, double* out);
+    MINIJS_API int32_t minijs_array_dot(void* arrA, void* arrB, double* out); // length = min of both
+    MINIJS_API int32_t minijs_array_index_of_number(void* arrHandle, double needle, int32_t fromIndex); // -1 if not found
+    MINIJS_API void    minijs_array_fill_number(void* arrHandle, double value, int32_t start, int32_t end);
+    // "scalar", "sse2" or "avx2" (static string, do not free)
+    MINIJS_API const char* minijs_simd_level();
+
     // ----------------------------
     // Object API
     // ----------------------------
@@ -108,6 +371,65 @@ extern "C" {
     // Returns JSON array string: ["a","b"] (free via minijs_free)
     MINIJS_API char* minijs_object_keys(void* objHandle);
 
+    // ----------------------------
+    // Object templates (shared shape)
+    // ----------------------------
+    // A template fixes an ordered field list once; every instance shares its
+    // shape, so an object is built in one call instead of one set per field.
+    // values holds exactly fieldCount entries in template order; like
+    // minijs_object_set, strings are copied and handles are NOT consumed.
+    // Release templates with minijs_handle_release.
+    MINIJS_API void* minijs_template_create(const char* const* keys, int32_t count);
+    MINIJS_API void* minijs_object_from_template(void* tplHandle, const minijs_value* values, int32_t count);
+    // Batch: builds `rows` objects from rows*fieldCount values and pushes them onto arrHandle.
+    MINIJS_API void  minijs_objects_from_template(void* tplHandle, const minijs_value* values, int32_t rows, void* arrHandle);
+
+    // ----------------------------
+    // Map / Set API
+    // ----------------------------
+    // Backed by open-addressing (Swiss-table style) hash tables with a dense,
+    // insertion-ordered entry array; keys use SameValueZero like the script side.
+    // Iterate with a cursor starting at 0: *_next returns 0 once exhausted.
+    // Returned strings must be freed via minijs_free, returned handles are owned.
+    MINIJS_API void*   minijs_map_create();
+    MINIJS_API int32_t minijs_map_size(void* mapHandle);
+    MINIJS_API int32_t minijs_map_has(void* mapHandle, const minijs_value* key);
+    MINIJS_API void    minijs_map_get(void* mapHandle, const minijs_value* key, minijs_value* out);
+    MINIJS_API void    minijs_map_set(void* mapHandle, const minijs_value* key, const minijs_value* v);
+    MINIJS_API int32_t minijs_map_delete(void* mapHandle, const minijs_value* key);
+    MINIJS_API void    minijs_map_clear(void* mapHandle);
+    MINIJS_API int32_t minijs_map_next(void* mapHandle, int32_t* cursor, minijs_value* outKey, minijs_value* outValue);
+
+    MINIJS_API void*   minijs_set_create();
+    MINIJS_API int32_t minijs_set_size(void* setHandle);
+    MINIJS_API int32_t minijs_set_has(void* setHandle, const minijs_value* v);
+    MINIJS_API void    minijs_set_add(void* setHandle, const minijs_value* v);
+    MINIJS_API int32_t minijs_set_delete(void* setHandle, const minijs_value* v);
+    MINIJS_API void    minijs_set_clear(void* setHandle);
+    MINIJS_API int32_t minijs_set_next(void* setHandle, int32_t* cursor, minijs_value* out);
+
+    // ----------------------------
+    // Regular expressions
+    // ----------------------------
+    // Compiled regexes are cached per interpreter, keyed by (pattern, flags), LRU.
+    // Patterns without backreferences/lookaround run on a lazily built DFA
+    // (bit-parallel for short patterns); only the rest use the backtracking matcher.
+#pragma pack(push, 8)
+    typedef struct minijs_regex_stats {
+        uint64_t hits;
+        uint64_t misses;          // compilations
+        uint64_t evictions;
+        uint64_t dfa_compiled;    // misses that got the DFA/bit-parallel path
+        uint64_t backtracking;    // misses that needed the backtracking matcher
+        int32_t  entries;
+        int32_t  capacity;
+    } minijs_regex_stats;
+#pragma pack(pop)
+
+    MINIJS_API void minijs_regex_cache_stats(void* it, minijs_regex_stats* out); // any thread
+    // Default 256; 0 disables caching (every match recompiles).
+    MINIJS_API void minijs_regex_cache_set_capacity(void* it, int32_t capacity);
+
 #ifdef __cplusplus
 }
 #endif
@@ -3,10 +3,30 @@
 
 #include <string>
 #include <vector>
+#include <initializer_list>
 #include <functional>
+#include <atomic>
+#include <chrono>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <memory_resource>
+#include <string_view>
 #include <stdexcept>
 #include <cstdint>
 #include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include <charconv>
+#include <limits>
+#include <utility>
+#include <type_traits>
+#ifdef MINIJSPP_TRACK_HANDLES
+#include <mutex>
+#include <map>
+#include <tuple>
+#include <iostream>
+#endif
 
 // ------------------------------------------------------------
 // If your Api.h doesn't declare the extended API yet,
@@ -34,13 +54,451 @@ extern "C" {
 
 namespace minijspp {
 
+    // ------------------------------------------------------------
+    // Number <-> string (same rules as the runtime's String(n) / Number(s))
+    // Shortest round-trip digits come from std::to_chars (Ryu-class),
+    // parsing uses std::from_chars (Eisel-Lemire-class) - no locale, no allocs
+    // besides the returned string (digits are split on the stack).
+    // ------------------------------------------------------------
+
+    inline std::string numberToString(double x) {
+        if (std::isnan(x)) return "NaN";
+        if (x == 0.0) return "0";
+        if (std::isinf(x)) return x < 0 ? "-Infinity" : "Infinity";
+
+        char sci[32];
+        auto r = std::to_chars(sci, sci + sizeof(sci), x < 0 ? -x : x, std::chars_format::scientific);
+
+        // "d.ddde+XX" => digits "dddd", n = XX + 1 (decimal point position)
+        char digits[24];
+        int k = 0;
+        const char* q = sci;
+        for (; q < r.ptr && *q != 'e'; q++) {
+            if (*q != '.') digits[k++] = *q;
+        }
+        int exp10 = 0;
+        std::from_chars(q + (q[1] == '+' ? 2 : 1), r.ptr, exp10);
+        int n = exp10 + 1;
+
+        // longest case: "-d.dddddddddddddddde-324" / "-0.00000" + 17 digits (< 40)
+        char out[40];
+        char* o = out;
+        if (x < 0) *o++ = '-';
+
+        if (k <= n && n <= 21) {
+            std::memcpy(o, digits, (size_t)k); o += k;
+            std::memset(o, '0', (size_t)(n - k)); o += n - k;
+        }
+        else if (0 < n && n <= 21) {
+            std::memcpy(o, digits, (size_t)n); o += n;
+            *o++ = '.';
+            std::memcpy(o, digits + n, (size_t)(k - n)); o += k - n;
+        }
+        else if (-6 < n && n <= 0) {
+            *o++ = '0';
+            *o++ = '.';
+            std::memset(o, '0', (size_t)(-n)); o += -n;
+            std::memcpy(o, digits, (size_t)k); o += k;
+        }
+        else {
+            int e = n - 1;
+            *o++ = digits[0];
+            if (k > 1) {
+                *o++ = '.';
+                std::memcpy(o, digits + 1, (size_t)(k - 1)); o += k - 1;
+            }
+            *o++ = 'e';
+            *o++ = e < 0 ? '-' : '+';
+            o = std::to_chars(o, out + sizeof(out), e < 0 ? -e : e).ptr;
+        }
+        return std::string(out, o);
+    }
+
+    // 0x / 0o / 0b literal digits (no sign, no separators). Keeps the leading
+    // 60+ bits exact and folds the rest into a sticky bit, so the single
+    // uint64 -> double conversion rounds like JS does; ldexp overflows to Infinity.
+    inline double parseRadixDigits(const char* p, const char* end, int bits) {
+        if (p == end) return std::numeric_limits<double>::quiet_NaN();
+        const uint32_t radix = 1u << bits;
+        uint64_t m = 0;
+        int exp = 0;
+        bool sticky = false;
+        for (; p < end; p++) {
+            char c = *p;
+            uint32_t d;
+            if (c >= '0' && c <= '9') d = (uint32_t)(c - '0');
+            else if (c >= 'a' && c <= 'f') d = (uint32_t)(c - 'a' + 10);
+            else if (c >= 'A' && c <= 'F') d = (uint32_t)(c - 'A' + 10);
+            else return std::numeric_limits<double>::quiet_NaN();
+            if (d >= radix) return std::numeric_limits<double>::quiet_NaN();
+
+            if (m < (uint64_t(1) << (64 - bits))) {
+                m = (m << bits) | d;
+            }
+            else {
+                exp += bits;
+                sticky |= (d != 0);
+            }
+        }
+        if (sticky) m |= 1; // m has >= 60 significant bits here, far below the rounding bit
+        return std::ldexp((double)m, exp);
+    }
+
+    // JS Number(s): surrounding whitespace ignored, "" => 0, NaN if not numeric
+    inline double stringToNumber(const std::string& s) {
+        const double nan = std::numeric_limits<double>::quiet_NaN();
+
+        size_t b = 0, e = s.size();
+        auto isws = [](char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\f' || c == '\v'; };
+        while (b < e && isws(s[b])) b++;
+        while (e > b && isws(s[e - 1])) e--;
+        if (b == e) return 0.0;
+
+        const char* p = s.data() + b;
+        const char* end = s.data() + e;
+
+        if (end - p >= 2 && p[0] == '0') {
+            switch (p[1]) {
+            case 'x': case 'X': return parseRadixDigits(p + 2, end, 4);
+            case 'o': case 'O': return parseRadixDigits(p + 2, end, 3);
+            case 'b': case 'B': return parseRadixDigits(p + 2, end, 1);
+            default: break;
+            }
+        }
+
+        bool neg = false;
+        if (*p == '+' || *p == '-') {
+            neg = (*p == '-');
+            p++;
+        }
+        if (end - p == 8 && std::memcmp(p, "Infinity", 8) == 0) {
+            return neg ? -std::numeric_limits<double>::infinity() : std::numeric_limits<double>::infinity();
+        }
+        // from_chars would accept "inf"/"nan" spellings JS rejects
+        if (p == end || !((*p >= '0' && *p <= '9') || *p == '.')) return nan;
+
+        double v = 0.0;
+        auto r = std::from_chars(p, end, v, std::chars_format::general);
+        if (r.ptr != end) return nan;
+        if (r.ec == std::errc::result_out_of_range) {
+            // overflow => Infinity, underflow => 0 (JS semantics); v is untouched
+            // by from_chars here, so estimate the decimal exponent ourselves
+            const char* q = p;
+            long mag = 0;
+            while (q < end && *q == '0') q++;
+            if (q < end && *q >= '1' && *q <= '9') {
+                while (q < end && *q >= '0' && *q <= '9') { q++; mag++; }
+                mag--;
+            }
+            else {
+                if (q < end && *q == '.') q++;
+                while (q < end && *q == '0') { q++; mag--; }
+                mag--;
+            }
+            while (q < end && *q != 'e' && *q != 'E') q++;
+            if (q < end) mag += std::strtol(q + 1, nullptr, 10);
+            v = (mag > 0) ? std::numeric_limits<double>::infinity() : 0.0;
+        }
+        else if (r.ec != std::errc()) {
+            return nan;
+        }
+        return neg ? -v : v;
+    }
+
+    // ------------------------------------------------------------
+
     class Engine;
     class Object;
     class Array;
     class Function;
     class Class;
+    class Map;
+    class Set;
+    class ObjectTemplate;
+    class SharedValue;
+    class WeakRef;
+
+    // Thrown by Engine::runWithFuel when the script ran out of its budget
+    class FuelExhausted : public std::runtime_error {
+    public:
+        FuelExhausted(uint64_t budget, uint64_t consumed)
+            : std::runtime_error("fuel exhausted"), _budget(budget), _consumed(consumed) {}
+
+        uint64_t budget() const { return _budget; }
+        uint64_t consumed() const { return _consumed; }
+
+    private:
+        uint64_t _budget;
+        uint64_t _consumed;
+    };
+
+    // ------------------------------------------------------------
+    // Handle tracking (debug aid, off by default). Build with
+    // -DMINIJSPP_TRACK_HANDLES (in every TU that includes this header) and
+    // each handle reference owned by a Value, UniqueHandle or ObjectTemplate
+    // is recorded with the source location that created it. ~Engine prints
+    // whatever is still held to stderr; Engine::liveHandles() returns it.
+    // A reference belongs to the Engine it came through: the Engine factories,
+    // a native callback of that Engine (any thread), or the object it was read
+    // from. References none of these apply to are reported and dropped when the
+    // last Engine goes. Without the macro all of this compiles to nothing.
+    // ------------------------------------------------------------
+
+    struct HandleSite {
+#ifdef MINIJSPP_TRACK_HANDLES
+        const char* file;
+        int line;
+        void* engine;   // interpreter the reference belongs to (nullptr = infer)
+
+        // As a default argument this captures the caller's location
+        static HandleSite current(const char* file = __builtin_FILE(), int line = __builtin_LINE()) { return HandleSite{ file, line, nullptr }; }
+
+        HandleSite in(void* it) const { return HandleSite{ file, line, it }; }
+#else
+        static HandleSite current() { return HandleSite{}; }
+        HandleSite in(void*) const { return *this; }
+#endif
+    };
+
+    // Outstanding references of one kind created at one site
+    struct LiveHandles {
+        int32_t kind;              // Value::Kind, or -1 for an ObjectTemplate
+        std::string file;
+        int line;
+        size_t count;
+        std::vector<uint64_t> ids; // minijs_handle_identity, matches heap snapshot node ids
+    };
+
+    class HandleTracker {
+    public:
+#ifdef MINIJSPP_TRACK_HANDLES
+        // Returns the ticket that identifies this one reference in release()
+        static uint64_t acquire(void* h, int32_t kind, HandleSite site) {
+            std::lock_guard<std::mutex> lock(state().m);
+            if (!site.engine) site.engine = engineOfLocked(h);
+            if (!site.engine) site.engine = activeEngine();
+            return addLocked(h, kind, site);
+        }
+
+        // Copies inherit site and engine of the reference they were copied from
+        static uint64_t copy(void* h, int32_t kind, uint64_t fromTicket) {
+            std::lock_guard<std::mutex> lock(state().m);
+            auto it = state().refs.find(fromTicket);
+            HandleSite site{ "<copy of a borrowed value>", 0, nullptr };
+            if (it != state().refs.end()) site = it->second.site;
+            if (!site.engine) site.engine = engineOfLocked(h);
+            if (!site.engine) site.engine = activeEngine();
+            return addLocked(h, kind, site);
+        }
+
+        static void release(void* h, uint64_t ticket) {
+            if (!ticket) return;
+            std::lock_guard<std::mutex> lock(state().m);
+            if (state().refs.erase(ticket) == 0) return; // engine already gone (see forget)
+            auto it = state().handles.find(h);
+            if (it != state().handles.end() && --it->second.count == 0) state().handles.erase(it);
+        }
+
+        // Engine owning h as far as the tracker knows (nullptr if none)
+        static void* engineOf(void* h) {
+            std::lock_guard<std::mutex> lock(state().m);
+            return engineOfLocked(h);
+        }
+
+        // Native callbacks: untraceable references created inside belong to this engine
+        class Scope {
+        public:
+            explicit Scope(void* it) : _prev(activeEngine()) { activeEngine() = it; }
+            ~Scope() { activeEngine() = _prev; }
+            Scope(const Scope&) = delete;
+            Scope& operator=(const Scope&) = delete;
+        private:
+            void* _prev;
+        };
+
+        static std::vector<LiveHandles> live(void* engine) {
+            std::lock_guard<std::mutex> lock(state().m);
+            return liveLocked(engine);
+        }
+
+        static void report(void* engine) {
+            print(live(engine), "at Engine destruction");
+        }
+
+        // Engine constructed (counted so forget() knows when the last one goes)
+        static void attach(void*) {
+            std::lock_guard<std::mutex> lock(state().m);
+            state().engines++;
+        }
+
+        // Engine destroyed: drop its entries so a new engine reusing the
+        // address does not inherit them (their handles are dead anyway).
+        // With the last engine gone every handle is dead, so the references
+        // that could not be attributed to an engine are reported and dropped too.
+        static void forget(void* engine) {
+            std::vector<LiveHandles> orphans;
+            {
+                std::lock_guard<std::mutex> lock(state().m);
+                if (state().engines) state().engines--;
+                if (state().engines == 0) {
+                    orphans = liveLocked(nullptr);
+                    state().refs.clear();
+                    state().handles.clear();
+                }
+                else {
+                    for (auto it = state().refs.begin(); it != state().refs.end();) {
+                        if (it->second.site.engine == engine) it = state().refs.erase(it);
+                        else ++it;
+                    }
+                    for (auto it = state().handles.begin(); it != state().handles.end();) {
+                        if (it->second.engine == engine) it = state().handles.erase(it);
+                        else ++it;
+                    }
+                }
+            }
+            print(orphans, "without an owning Engine when the last Engine was destroyed");
+        }
+
+    private:
+        struct Ref {
+            void* h;
+            int32_t kind;
+            HandleSite site;
+        };
+
+        struct HandleInfo {
+            void* engine;
+            size_t count;
+        };
+
+        struct State {
+            std::mutex m;
+            uint64_t nextTicket = 1;
+            size_t engines = 0;                               // live Engine instances
+            std::unordered_map<uint64_t, Ref> refs;           // ticket -> reference
+            std::unordered_map<void*, HandleInfo> handles;    // handle -> owning engine
+        };
+
+        static std::vector<LiveHandles> liveLocked(void* engine) {
+            std::map<std::tuple<int32_t, std::string, int>, LiveHandles> bySite;
+            for (const auto& kv : state().refs) {
+                const Ref& r = kv.second;
+                if (r.site.engine != engine) continue;
+                LiveHandles& l = bySite[std::make_tuple(r.kind, std::string(r.site.file), r.site.line)];
+                if (l.count == 0) {
+                    l.kind = r.kind;
+                    l.file = r.site.file;
+                    l.line = r.site.line;
+                }
+                l.count++;
+                l.ids.push_back(minijs_handle_identity(r.h));
+            }
+            std::vector<LiveHandles> out;
+            for (auto& kv : bySite) out.push_back(std::move(kv.second));
+            return out;
+        }
+
+        static void print(const std::vector<LiveHandles>& live, const char* when) {
+            if (live.empty()) return;
+            size_t total = 0;
+            std::map<std::string, size_t> perKind;
+            for (const LiveHandles& l : live) {
+                total += l.count;
+                perKind[kindName(l.kind)] += l.count;
+            }
+            std::cerr << "minijspp: " << total << " handle reference(s) still held " << when << ":";
+            for (const auto& kv : perKind) std::cerr << " " << kv.first << "=" << kv.second;
+            std::cerr << "\n";
+            for (const LiveHandles& l : live) {
+                std::cerr << "  " << l.count << " x " << kindName(l.kind) << " from " << l.file << ":" << l.line << " (id";
+                for (size_t i = 0; i < l.ids.size() && i < 8; i++) std::cerr << " " << l.ids[i];
+                if (l.ids.size() > 8) std::cerr << " ...";
+                std::cerr << ")\n";
+            }
+        }
+
+        static State& state() {
+            static State s;
+            return s;
+        }
+
+        static void*& activeEngine() {
+            static thread_local void* e = nullptr;
+            return e;
+        }
+
+        static void* engineOfLocked(void* h) {
+            auto it = state().handles.find(h);
+            return it != state().handles.end() ? it->second.engine : nullptr;
+        }
+
+        static uint64_t addLocked(void* h, int32_t kind, HandleSite site) {
+            uint64_t ticket = state().nextTicket++;
+            state().refs.emplace(ticket, Ref{ h, kind, site });
+            HandleInfo& info = state().handles[h];
+            if (!info.engine) info.engine = site.engine;
+            info.count++;
+            return ticket;
+        }
+
+        static const char* kindName(int32_t k) {
+            switch (k) {
+            case MINIJS_ARRAY:    return "array";
+            case MINIJS_OBJECT:   return "object";
+            case MINIJS_FUNCTION: return "function";
+            case MINIJS_CLASS:    return "class";
+            case MINIJS_TASK:     return "task";
+            case MINIJS_MAP:      return "map";
+            case MINIJS_SET:      return "set";
+            case -1:              return "template";
+            default:              return "handle";
+            }
+        }
+#else
+        static uint64_t acquire(void*, int32_t, HandleSite) { return 0; }
+        static uint64_t copy(void*, int32_t, uint64_t) { return 0; }
+        static void release(void*, uint64_t) {}
+        static void* engineOf(void*) { return nullptr; }
+        class Scope {
+        public:
+            explicit Scope(void*) {}
+        };
+        static std::vector<LiveHandles> live(void*) { return {}; }
+        static void report(void*) {}
+        static void attach(void*) {}
+        static void forget(void*) {}
+#endif
+    };
+
+    // Bookkeeping for one owned handle reference. Owners derive from it
+    // privately, so it takes no space unless MINIJSPP_TRACK_HANDLES is set.
+    class TrackedRef {
+    protected:
+#ifdef MINIJSPP_TRACK_HANDLES
+        void track(void* h, int32_t kind, HandleSite site) { _ticket = HandleTracker::acquire(h, kind, site); }
+        void trackCopy(void* h, int32_t kind, const TrackedRef& from) { _ticket = HandleTracker::copy(h, kind, from._ticket); }
+        void untrack(void* h) {
+            HandleTracker::release(h, _ticket);
+            _ticket = 0;
+        }
+        void takeTicket(TrackedRef& o) {
+            _ticket = o._ticket;
+            o._ticket = 0;
+        }
+
+    private:
+        uint64_t _ticket = 0;
+#else
+        void track(void*, int32_t, HandleSite) {}
+        void trackCopy(void*, int32_t, const TrackedRef&) {}
+        void untrack(void*) {}
+        void takeTicket(TrackedRef&) {}
+#endif
+    };
+
+    // ------------------------------------------------------------
 
-    class Value {
+    class Value : private TrackedRef {
     public:
         enum class Kind : int32_t {
             Null = MINIJS_NULL,
@@ -51,59 +509,125 @@ namespace minijspp {
             Object = MINIJS_OBJECT,
             Function = MINIJS_FUNCTION,
             Class = MINIJS_CLASS,
-            Task = MINIJS_TASK
+            Task = MINIJS_TASK,
+            Int = MINIJS_INT,
+            Map = MINIJS_MAP,
+            Set = MINIJS_SET
         };
 
-        Value() : _kind(Kind::Null), _num(0.0), _b(false), _h(nullptr) {}
+        Value() : _kind(Kind::Null), _num(0.0), _i(0), _b(false), _h(nullptr), _borrowed(false) {}
 
         static Value Null() { return Value(); }
         static Value Number(double n) { Value v; v._kind = Kind::Number; v._num = n; return v; }
+        static Value Int(int32_t i) { Value v; v._kind = Kind::Int; v._i = i; return v; }
         static Value Bool(bool b) { Value v; v._kind = Kind::Bool; v._b = b; return v; }
         static Value String(std::string s) { Value v; v._kind = Kind::String; v._s = std::move(s); return v; }
 
-        static Value Handle(Kind k, void* h, bool retain) {
+        static Value Handle(Kind k, void* h, bool retain, HandleSite site = HandleSite::current()) {
             Value v;
             v._kind = k;
             v._h = h;
             if (retain && v._h) minijs_handle_retain(v._h);
+            if (v._h) v.track(v._h, (int32_t)k, site);
             return v;
         }
 
         Kind kind() const { return _kind; }
         bool isHandleKind() const {
-            return _kind == Kind::Array || _kind == Kind::Object || _kind == Kind::Function || _kind == Kind::Class || _kind == Kind::Task;
+            return _kind == Kind::Array || _kind == Kind::Object || _kind == Kind::Function || _kind == Kind::Class || _kind == Kind::Task
+                || _kind == Kind::Map || _kind == Kind::Set;
         }
 
+        bool isNumber() const { return _kind == Kind::Number || _kind == Kind::Int; }
+
         double toNumber(double def = 0.0) const {
             if (_kind == Kind::Number) return _num;
+            if (_kind == Kind::Int) return (double)_i;
             if (_kind == Kind::Bool) return _b ? 1.0 : 0.0;
             return def;
         }
 
+        // Int is returned as-is; doubles follow JS ToInt32 (truncate, wrap mod 2^32)
+        int32_t toInt32(int32_t def = 0) const {
+            if (_kind == Kind::Int) return _i;
+            if (_kind == Kind::Bool) return _b ? 1 : 0;
+            if (_kind != Kind::Number) return def;
+            if (_num >= -2147483648.0 && _num < 2147483648.0) return (int32_t)_num;
+            if (!std::isfinite(_num)) return 0;
+            double m = std::fmod(std::trunc(_num), 4294967296.0);
+            if (m < 0) m += 4294967296.0;
+            return (int32_t)(uint32_t)m;
+        }
+
         bool toBool(bool def = false) const {
             if (_kind == Kind::Bool) return _b;
             if (_kind == Kind::Number) return _num != 0.0;
+            if (_kind == Kind::Int) return _i != 0;
             return def;
         }
 
         const std::string& toStringRef() const { return _s; }
 
+        // Primitive toString(); handle kinds are not stringified on the host side
+        std::string toString() const {
+            switch (_kind) {
+            case Kind::Null:   return "null";
+            case Kind::Number: return numberToString(_num);
+            case Kind::Int:    return std::to_string(_i);
+            case Kind::Bool:   return _b ? "true" : "false";
+            case Kind::String: return _s;
+            default:           return std::string();
+            }
+        }
+
         void* handle() const { return _h; }
 
+        // Same object <=> same identity (handle pointers may differ)
+        uint64_t identity() const {
+            if (!_h || !isHandleKind()) return 0;
+            return minijs_handle_identity(_h);
+        }
+
+        // SameValueZero for primitives (NaN == NaN, +0 == -0, Int == Number),
+        // object identity for handles. Consistent with std::hash<Value>.
+        bool operator==(const Value& o) const {
+            if (isNumber() && o.isNumber()) {
+                double a = toNumber(), b = o.toNumber();
+                return a == b || (std::isnan(a) && std::isnan(b));
+            }
+            if (_kind != o._kind) return false;
+            switch (_kind) {
+            case Kind::Null:   return true;
+            case Kind::Bool:   return _b == o._b;
+            case Kind::String: return _s == o._s;
+            default:           return _h == o._h || identity() == o.identity();
+            }
+        }
+
+        bool operator!=(const Value& o) const { return !(*this == o); }
+
         // Transfer ownership to runtime (for "consumed handle" APIs)
         void* detachHandle() {
             void* h = _h;
+            if (_borrowed && h) minijs_handle_retain(h); // runtime consumes a reference we never had
+            else if (h && isHandleKind()) untrack(h);
+            _borrowed = false;
             _h = nullptr;
             _kind = Kind::Null;
             _num = 0.0;
+            _i = 0;
             _b = false;
             _s.clear();
             return h;
         }
 
         // Copy retains handle
-        Value(const Value& o) : _kind(o._kind), _num(o._num), _b(o._b), _s(o._s), _h(o._h) {
-            if (_h && isHandleKind()) minijs_handle_retain(_h);
+        // (copies of borrowed values are owning)
+        Value(const Value& o) : _kind(o._kind), _num(o._num), _i(o._i), _b(o._b), _s(o._s), _h(o._h), _borrowed(false) {
+            if (_h && isHandleKind()) {
+                minijs_handle_retain(_h);
+                trackCopy(_h, (int32_t)_kind, o);
+            }
         }
 
         Value& operator=(const Value& o) {
@@ -111,18 +635,26 @@ namespace minijspp {
             cleanup();
             _kind = o._kind;
             _num = o._num;
+            _i = o._i;
             _b = o._b;
             _s = o._s;
             _h = o._h;
-            if (_h && isHandleKind()) minijs_handle_retain(_h);
+            _borrowed = false;
+            if (_h && isHandleKind()) {
+                minijs_handle_retain(_h);
+                trackCopy(_h, (int32_t)_kind, o);
+            }
             return *this;
         }
 
         // Move transfers handle
-        Value(Value&& o) noexcept : _kind(o._kind), _num(o._num), _b(o._b), _s(std::move(o._s)), _h(o._h) {
+        Value(Value&& o) noexcept : _kind(o._kind), _num(o._num), _i(o._i), _b(o._b), _s(std::move(o._s)), _h(o._h), _borrowed(o._borrowed) {
+            takeTicket(o);
             o._h = nullptr;
+            o._borrowed = false;
             o._kind = Kind::Null;
             o._num = 0.0;
+            o._i = 0;
             o._b = false;
         }
 
@@ -131,23 +663,29 @@ namespace minijspp {
             cleanup();
             _kind = o._kind;
             _num = o._num;
+            _i = o._i;
             _b = o._b;
             _s = std::move(o._s);
             _h = o._h;
+            _borrowed = o._borrowed;
+            takeTicket(o);
             o._h = nullptr;
+            o._borrowed = false;
             o._kind = Kind::Null;
             o._num = 0.0;
+            o._i = 0;
             o._b = false;
             return *this;
         }
 
         ~Value() { cleanup(); }
 
-        static Value fromNative(const minijs_value& nv, bool retainHandle) {
+        static Value fromNative(const minijs_value& nv, bool retainHandle, HandleSite site = HandleSite::current()) {
             Kind k = (Kind)nv.kind;
             switch (k) {
             case Kind::Null:   return Value::Null();
             case Kind::Number: return Value::Number(nv.num);
+            case Kind::Int:    return Value::Int(nv.i32);
             case Kind::Bool:   return Value::Bool(nv.boolean != 0);
             case Kind::String: return Value::String(nv.str ? std::string(nv.str) : std::string());
             case Kind::Array:
@@ -155,24 +693,84 @@ namespace minijspp {
             case Kind::Function:
             case Kind::Class:
             case Kind::Task:
-                return Value::Handle(k, nv.handle, retainHandle);
+            case Kind::Map:
+            case Kind::Set:
+                return Value::Handle(k, nv.handle, retainHandle, site);
             }
             return Value::Null();
         }
 
+        // For runtime "out" values: string is minijs_malloc'ed (freed here),
+        // handle is already retained for the caller
+        static Value fromNativeOwned(const minijs_value& out, HandleSite site = HandleSite::current()) {
+            Value v = fromNative(out, /*retainHandle=*/false, site);
+            if ((Kind)out.kind == Kind::String && out.str) {
+                minijs_free((void*)out.str);
+            }
+            return v;
+        }
+
+        // Non-retaining view of a runtime value that outlives this Value (callback
+        // args/thisVal). Never releases; copying it yields a normal owning Value.
+        static Value fromNativeBorrowed(const minijs_value& nv) {
+            Value v = fromNative(nv, /*retainHandle=*/false);
+            if (v._h && v.isHandleKind()) {
+                v._borrowed = true;
+                v.untrack(v._h);
+            }
+            return v;
+        }
+
+        bool isBorrowed() const { return _borrowed; }
+
+        // toString() of a runtime "out" value, allocated from mr; frees the
+        // string / releases the handle like fromNativeOwned (handles give "")
+        static std::pmr::string stringFromNativeOwned(const minijs_value& out, std::pmr::memory_resource* mr) {
+            Kind k = (Kind)out.kind;
+            if (k == Kind::String) {
+                std::pmr::string s(out.str ? out.str : "", mr);
+                if (out.str) minijs_free((void*)out.str);
+                return s;
+            }
+            if (out.handle && (k == Kind::Array || k == Kind::Object || k == Kind::Function || k == Kind::Class
+                || k == Kind::Task || k == Kind::Map || k == Kind::Set)) {
+                minijs_handle_release(out.handle);
+                return std::pmr::string(mr);
+            }
+            char buf[40];
+            const char* p = buf;
+            size_t n = 0;
+            switch (k) {
+            case Kind::Number: {
+                std::string t = numberToString(out.num); // <= 25 chars: SSO, no heap
+                n = t.size();
+                std::memcpy(buf, t.data(), n);
+                break;
+            }
+            case Kind::Int:  n = (size_t)(std::to_chars(buf, buf + sizeof(buf), out.i32).ptr - buf); break;
+            case Kind::Bool: p = out.boolean ? "true" : "false"; n = std::strlen(p); break;
+            default:         p = "null"; n = 4; break;
+            }
+            return std::pmr::string(p, n, mr);
+        }
+
     private:
         void cleanup() {
-            if (_h && isHandleKind()) {
+            if (_h && isHandleKind() && !_borrowed) {
+                untrack(_h);
                 minijs_handle_release(_h);
             }
             _h = nullptr;
+            _borrowed = false;
         }
 
         Kind _kind;
         double _num;
+        int32_t _i;
         bool _b;
         std::string _s;
         void* _h;
+        bool _borrowed;
     };
 
     // ------------------------------------------------------------
@@ -183,11 +781,17 @@ namespace minijspp {
 
         Engine() : _it(minijs_create()) {
             if (!_it) throw std::runtime_error("minijs_create() failed");
+            HandleTracker::attach(_it); // MINIJSPP_TRACK_HANDLES only
         }
 
         ~Engine() {
             for (Binding* b : _bindings) delete b;
             _bindings.clear();
+            _modules.clear();
+            _moduleSizes.clear();
+            clearCompileCache();
+            HandleTracker::report(_it); // MINIJSPP_TRACK_HANDLES only
+            HandleTracker::forget(_it);
             if (_it) {
                 minijs_destroy(_it);
                 _it = nullptr;
@@ -199,37 +803,392 @@ namespace minijspp {
 
         void* raw() const { return _it; }
 
+        // Opt-in: integral values then arrive as Value::Kind::Int (args, get(),
+        // thisVal) instead of Kind::Number. Only enable once the host's kind
+        // checks handle Int (isNumber()/toNumber() already do).
+        void setIntTransport(bool enabled) { minijs_set_int_transport(_it, enabled ? 1 : 0); }
+
+        // Opt-in (needs minijs_run_n): run(code) takes the result length from
+        // the runtime instead of scanning for the terminator.
+        void setResultLength(bool enabled) {
+            _resultLength = enabled;
+            _runCompiled = (_resultLength || _compileCapacity > 0) ? &Engine::runCompiled : nullptr;
+        }
+
+        // Handle references the host still owns, grouped by kind and creation
+        // site. Always empty unless built with MINIJSPP_TRACK_HANDLES.
+        std::vector<LiveHandles> liveHandles() const { return HandleTracker::live(_it); }
+
+        // By default the result is the runtime's NUL-terminated string (plain
+        // minijs_run + strlen). After setResultLength(true) or with the compile
+        // cache on, the length comes back with the result (minijs_run_n): no
+        // strlen, '\0' survives, and rope/StringBuilder results are flattened
+        // once straight into the buffer that is copied here.
         std::string run(const std::string& code) {
-            char* out = minijs_run(_it, code.c_str());
+            size_t len = 0;
+            char* out = runRaw(code, &len);
             if (!out) return std::string();
-            std::string s(out);
+            std::string s(out, len);
+            minijs_free(out);
+            return s;
+        }
+
+        // Writes the result into out, reusing its capacity: once out and the
+        // engine's scratch buffer are large enough, repeated runs don't allocate
+        // for the result at all and cost O(result length), not O(capacity).
+        void run(const std::string& code, std::string& out) {
+            void* script = cachedScript(code);
+            // The scratch buffer only grows, so it is zero-filled once, not per run
+            if (_resultBuf.size() < out.capacity()) _resultBuf.resize(out.capacity());
+            if (_resultBuf.empty()) _resultBuf.resize(256);
+            size_t len = 0;
+            // _resultBuf[size()] is the terminator slot => cap = size() + 1
+            int32_t fit = script
+                ? minijs_script_run_into(_it, script, &_resultBuf[0], _resultBuf.size() + 1, &len)
+                : minijs_run_into(_it, code.c_str(), &_resultBuf[0], _resultBuf.size() + 1, &len);
+            if (!fit) {
+                _resultBuf.resize(len);
+                minijs_last_result_into(_it, &_resultBuf[0], len + 1, &len);
+            }
+            out.assign(_resultBuf.data(), len);
+        }
+
+        // ----------------------------
+        // Cost accounting (CPU time in script / natives, allocation, GC, runs).
+        // Pooled engines: read stats() after a request, then resetStats().
+        // ----------------------------
+        using EngineStats = minijs_engine_stats;
+
+        EngineStats stats() const {
+            EngineStats st{};
+            minijs_get_stats(_it, &st);
+            return st;
+        }
+
+        void resetStats() { minijs_reset_stats(_it); }
+
+        // ----------------------------
+        // Generational GC (nursery + old space, see Api.h)
+        // ----------------------------
+        using GcConfig = minijs_gc_config;
+        using GcStats = minijs_gc_stats;
+
+        // Before the first run (throws afterwards)
+        void configureGc(const GcConfig& cfg) {
+            if (!minijs_gc_configure(_it, &cfg)) throw std::runtime_error("minijs_gc_configure: engine has already run");
+        }
+
+        GcStats gcStats() const {
+            GcStats st{};
+            minijs_gc_get_stats(_it, &st);
+            return st;
+        }
+
+        // e.g. between pooled requests, so the next one starts with an empty nursery
+        void collectGarbage(bool full = false) { minijs_gc_collect(_it, full ? 1 : 0); }
+
+        // ----------------------------
+        // Sampling allocation profiler (script stacks => bytes)
+        // ----------------------------
+        enum class ProfileFormat : int32_t {
+            Collapsed = MINIJS_PROFILE_COLLAPSED,                  // all sampled allocations
+            CollapsedRetained = MINIJS_PROFILE_COLLAPSED_RETAINED, // still alive at stop
+            Pprof = MINIJS_PROFILE_PPROF
+        };
+
+        using Sink = std::function<void(const char* data, size_t len)>;
+
+        void startAllocationProfile(uint64_t sampleIntervalBytes = 512 * 1024) {
+            if (sampleIntervalBytes == 0) throw std::runtime_error("startAllocationProfile: interval must be > 0");
+            if (!minijs_alloc_profile_start(_it, sampleIntervalBytes)) throw std::runtime_error("startAllocationProfile: profile already running");
+        }
+
+        void stopAllocationProfile(ProfileFormat format, const Sink& sink) {
+            if (!minijs_alloc_profile_stop(_it, (int32_t)format, &Engine::sinkThunk, (void*)&sink)) {
+                throw std::runtime_error("stopAllocationProfile: no profile running");
+            }
+        }
+
+        std::string stopAllocationProfile(ProfileFormat format = ProfileFormat::Collapsed) {
+            std::string out;
+            stopAllocationProfile(format, [&out](const char* data, size_t len) { out.append(data, len); });
+            return out;
+        }
+
+        // ----------------------------
+        // Heap snapshot (text format documented in Api.h; see heapstat.cpp)
+        // ----------------------------
+        void heapSnapshot(const Sink& sink) {
+            if (!minijs_heap_snapshot(_it, &Engine::sinkThunk, (void*)&sink)) throw std::runtime_error("minijs_heap_snapshot failed");
+        }
+
+        std::string heapSnapshot() {
+            std::string out;
+            heapSnapshot([&out](const char* data, size_t len) { out.append(data, len); });
+            return out;
+        }
+
+        // ----------------------------
+        // Fuel metering: deterministic per-run work budget (0 = unlimited)
+        // ----------------------------
+        void setFuel(uint64_t fuel) {
+            _fuel = fuel;
+            minijs_set_fuel(_it, fuel);
+        }
+
+        uint64_t fuel() const { return _fuel; }
+        uint64_t fuelConsumed() const { return minijs_fuel_consumed(_it); }
+
+        // Runs with a one-off budget (the engine-wide setFuel() value is restored).
+        // Throws FuelExhausted instead of returning the error string.
+        std::string runWithFuel(const std::string& code, uint64_t fuel) {
+            minijs_set_fuel(_it, fuel);
+            std::string res;
+            try {
+                res = run(code);
+            }
+            catch (...) {
+                minijs_set_fuel(_it, _fuel);
+                throw;
+            }
+            minijs_set_fuel(_it, _fuel);
+            if (minijs_last_error(_it) == MINIJS_ERR_FUEL) throw FuelExhausted(fuel, fuelConsumed());
+            return res;
+        }
+
+        // Result string allocated from mr (e.g. a RequestArena)
+        std::pmr::string run(const std::string& code, std::pmr::memory_resource* mr) {
+            size_t len = 0;
+            char* out = runRaw(code, &len);
+            if (!out) return std::pmr::string(mr);
+            std::pmr::string s(out, len, mr);
             minijs_free(out);
             return s;
         }
 
+        // ----------------------------
+        // Compile cache for run(code): LRU keyed by hash + length of the source
+        // (verified against the stored source on hit). Off by default.
+        // Sources that fail to compile are remembered too (negative entry): later
+        // runs are hits that go straight to the interpreter, parsed once.
+        // ----------------------------
+        struct CompileCacheStats {
+            uint64_t hits = 0;
+            uint64_t misses = 0;
+            uint64_t failures = 0;      // misses whose compile failed (syntax error)
+            uint64_t evictions = 0;
+            size_t entries = 0;
+            size_t capacity = 0;
+        };
+
+        // capacity 0 disables the cache and releases all compiled scripts
+        void setCompileCacheCapacity(size_t capacity) {
+            _compileCapacity = capacity;
+            _runCompiled = (_resultLength || _compileCapacity > 0) ? &Engine::runCompiled : nullptr;
+            while (_compiled.size() > _compileCapacity) evictOldestScript();
+        }
+
+        // Safe to call from another thread (e.g. a metrics exporter)
+        CompileCacheStats compileCacheStats() const {
+            CompileCacheStats st;
+            st.hits = _compileHits;
+            st.misses = _compileMisses;
+            st.failures = _compileFailures;
+            st.evictions = _compileEvictions;
+            st.entries = _compileEntries;
+            st.capacity = _compileCapacity;
+            return st;
+        }
+
+        void clearCompileCache() {
+            for (CompiledScript& c : _compiled) if (c.script) minijs_handle_release(c.script);
+            _compiled.clear();
+            _compiledIndex.clear();
+            _compileEntries = 0;
+        }
+
+        // ----------------------------
+        // Regex cache (per engine, keyed by pattern + flags)
+        // ----------------------------
+        using RegexCacheStats = minijs_regex_stats;
+
+        RegexCacheStats regexCacheStats() const {
+            RegexCacheStats st{};
+            minijs_regex_cache_stats(_it, &st);
+            return st;
+        }
+
+        void setRegexCacheCapacity(int32_t capacity) {
+            if (capacity < 0) throw std::runtime_error("setRegexCacheCapacity: negative capacity");
+            minijs_regex_cache_set_capacity(_it, capacity);
+        }
+
         // ----------------------------
         // Register global native function: name(...)
         // ----------------------------
         void registerFunction(const std::string& name, Callback cb) {
+            registerFunction(name, std::move(cb), FunctionFlags::None);
+        }
+
+        // Pure: result depends only on the (primitive) arguments. Calls are
+        // memoized in a bounded LRU keyed by the raw arguments, so a hit skips
+        // argument marshaling and the callback. Calls with object/array/function
+        // arguments and calls returning handles are never cached.
+        enum class FunctionFlags : uint32_t {
+            None = 0,
+            Pure = 1
+        };
+
+        struct MemoStats {
+            uint64_t hits = 0;
+            uint64_t misses = 0;
+            uint64_t evictions = 0;
+            size_t entries = 0;
+            size_t capacity = 0;
+        };
+
+        void registerFunction(const std::string& name, Callback cb, FunctionFlags flags, size_t memoCapacity = 1024) {
             if (name.empty()) throw std::runtime_error("registerFunction: name empty");
             Binding* b = new Binding();
             b->engine = this;
             b->cb = std::move(cb);
+            b->name = name;
+            if (flags == FunctionFlags::Pure) b->memo.reset(new MemoCache(memoCapacity));
             _bindings.push_back(b);
             minijs_register(_it, name.c_str(), &Engine::trampoline, b);
         }
 
+        // ----------------------------
+        // Per-binding call counters (all callbacks going through the trampoline)
+        // ----------------------------
+        struct BindingStats {
+            std::string name;       // "" for unnamed createFunction() callbacks
+            uint64_t calls = 0;     // includes fastCalls
+            uint64_t fastCalls = 0; // registerFastFunction: direct calls (counted by the runtime)
+            bool fast = false;      // registerFastFunction binding; nanos then covers only fallback calls
+            uint64_t errors = 0;    // callbacks that threw
+            uint64_t nanos = 0;     // wall time, only with setBindingTiming(true)
+            uint64_t memoHits = 0;
+            uint64_t memoMisses = 0;
+        };
+
+        // Adds two clock reads per native call
+        void setBindingTiming(bool enabled) { _bindingTiming = enabled; }
+
+        // Safe to call from another thread once registration is done
+        std::vector<BindingStats> bindingStats() const {
+            std::vector<BindingStats> res;
+            auto add = [this, &res](const Binding& b) {
+                BindingStats st;
+                st.name = b.name;
+                st.calls = b.calls;
+                st.fast = b.fast;
+                if (b.fast) {
+                    st.fastCalls = minijs_fast_calls(_it, b.name.c_str());
+                    st.calls += st.fastCalls;
+                }
+                st.errors = b.errors;
+                st.nanos = b.nanos;
+                if (b.memo) {
+                    st.memoHits = b.memo->hits;
+                    st.memoMisses = b.memo->misses;
+                }
+                res.push_back(std::move(st));
+            };
+            for (const Binding* b : _bindings) add(*b);
+            for (size_t m = 0; m < _modules.size(); m++) {
+                for (size_t i = 0; i < _moduleSizes[m]; i++) add(_modules[m][i]);
+            }
+            return res;
+        }
+
+        // Stats of the most recent pure registration of name (zeros if none)
+        MemoStats memoStats(const std::string& name) const {
+            MemoStats st;
+            for (auto it = _bindings.rbegin(); it != _bindings.rend(); ++it) {
+                const Binding* b = *it;
+                if (b->name != name || !b->memo) continue;
+                st.hits = b->memo->hits;
+                st.misses = b->memo->misses;
+                st.evictions = b->memo->evictions;
+                st.entries = b->memo->entries.size();
+                st.capacity = b->memo->capacity;
+                break;
+            }
+            return st;
+        }
+
+        // ----------------------------
+        // Register a namespace of natives in one ABI call:
+        //   js.registerModule("geo", {{"lookup", cb1}, {"distance", cb2}});
+        // Scripts call geo.lookup(...). Bindings share one allocation.
+        // ----------------------------
+        using ModuleFunction = std::pair<std::string, Callback>;
+
+        void registerModule(const std::string& name, std::initializer_list<ModuleFunction> fns, bool lazy = true) {
+            registerModule(name, std::vector<ModuleFunction>(fns), lazy);
+        }
+
+        void registerModule(const std::string& name, std::vector<ModuleFunction> fns, bool lazy = true) {
+            if (name.empty()) throw std::runtime_error("registerModule: name empty");
+
+            std::unique_ptr<Binding[]> block(new Binding[fns.size()]());
+            std::vector<minijs_native_entry> entries(fns.size());
+            for (size_t i = 0; i < fns.size(); i++) {
+                if (fns[i].first.empty()) throw std::runtime_error("registerModule: function name empty");
+                Binding& b = block[i];
+                b.engine = this;
+                b.cb = std::move(fns[i].second);
+                b.name = name + "." + fns[i].first;
+                entries[i].name = fns[i].first.c_str();
+                entries[i].cb = &Engine::trampoline;
+                entries[i].userdata = &b;
+            }
+
+            minijs_register_module(_it, name.c_str(), entries.data(), (int32_t)entries.size(), lazy ? 1 : 0);
+            _modules.push_back(std::move(block));
+            _moduleSizes.push_back(fns.size());
+        }
+
+        // ----------------------------
+        // Register pure numeric function: double fn(double, ...) with up to 4 args.
+        // The runtime calls fn directly for number arguments; anything else goes
+        // through the generic trampoline with JS ToNumber coercion.
+        // ----------------------------
+        template <typename... Args>
+        void registerFastFunction(const std::string& name, double(*fn)(Args...)) {
+            static_assert(sizeof...(Args) <= 4, "registerFastFunction: at most 4 arguments");
+            static_assert((std::is_same<Args, double>::value && ...), "registerFastFunction: arguments must be double");
+            if (name.empty()) throw std::runtime_error("registerFastFunction: name empty");
+            if (!fn) throw std::runtime_error("registerFastFunction: fn is null");
+
+            Binding* b = new Binding();
+            b->engine = this;
+            b->name = name;
+            b->cb = [fn](const std::vector<Value>& args, const Value&) {
+                return Value::Number(callFast(fn, args, std::index_sequence_for<Args...>{}));
+            };
+            b->fast = true;
+            _bindings.push_back(b);
+            minijs_register_fast_f64(_it, name.c_str(), (minijs_fast_fn)fn, (int32_t)sizeof...(Args), &Engine::trampoline, b);
+        }
+
         // ----------------------------
         // Create a Function handle (for class methods etc.)
         // ----------------------------
-        Function createFunction(Callback cb);
+        // name only labels the binding in bindingStats()
+        // (site: creation location recorded under MINIJSPP_TRACK_HANDLES; leave defaulted)
+        Function createFunction(Callback cb, const std::string& name = std::string(), HandleSite site = HandleSite::current());
 
         // ----------------------------
         // Create Class / Object / Array
         // ----------------------------
-        Class createClass(const std::string& name);
-        Object createObject();
-        Array createArray();
+        Class createClass(const std::string& name, HandleSite site = HandleSite::current());
+        Object createObject(HandleSite site = HandleSite::current());
+        Array createArray(HandleSite site = HandleSite::current());
+        Map createMap(HandleSite site = HandleSite::current());
+        Set createSet(HandleSite site = HandleSite::current());
+        ObjectTemplate createObjectTemplate(const std::vector<std::string>& keys, HandleSite site = HandleSite::current());
 
         // ----------------------------
         // Declare value into global scope
@@ -276,12 +1235,25 @@ namespace minijspp {
             if (tmp) minijs_free(tmp);
         }
 
+        // Runs fn once when v's object is collected (or when the engine is
+        // destroyed, whichever comes first). fn must not keep v alive.
+        // Repeated calls on the same object stack: every fn runs (newest first)
+        // and each heap-held copy is freed after it ran.
+        void onFinalize(const Value& v, std::function<void()> fn) {
+            if (!v.isHandleKind() || !v.handle()) throw std::runtime_error("onFinalize: value has no handle");
+            std::function<void()>* p = new std::function<void()>(std::move(fn));
+            minijs_set_finalizer(v.handle(), &Engine::finalizeThunk, p);
+        }
+
+        // Binds an immutable shared value by reference (no per-engine copy)
+        void declareShared(const std::string& name, const SharedValue& v);
+
         // ------------------------------------------------------------
         // IMPORTANT: this is PUBLIC (your original error was "private")
         // Used by Object/Array set/push.
         // If string needs temporary allocation, outTempStr is set.
         // ------------------------------------------------------------
-        minijs_value valueToNativeArg(const Value& v, char** outTempStr) {
+        static minijs_value valueToNativeArg(const Value& v, char** outTempStr) {
             if (outTempStr) *outTempStr = nullptr;
 
             minijs_value nv{};
@@ -301,8 +1273,14 @@ namespace minijspp {
                 nv.num = v.toNumber();
                 return nv;
 
-            case Value::Kind::Bool:
-                nv.kind = MINIJS_BOOL;
+            case Value::Kind::Int:
+                nv.kind = MINIJS_INT;
+                nv.num = v.toNumber();
+                nv.i32 = v.toInt32();
+                return nv;
+
+            case Value::Kind::Bool:
+                nv.kind = MINIJS_BOOL;
                 nv.boolean = v.toBool() ? 1 : 0;
                 return nv;
 
@@ -316,6 +1294,8 @@ namespace minijspp {
             case Value::Kind::Function:
             case Value::Kind::Class:
             case Value::Kind::Task:
+            case Value::Kind::Map:
+            case Value::Kind::Set:
                 nv.kind = (int32_t)v.kind();
                 nv.handle = v.handle();
                 return nv;
@@ -324,11 +1304,260 @@ namespace minijspp {
         }
 
     private:
+        // LRU of (argument list -> primitive result) for pure bindings
+        struct MemoCache {
+            struct Arg {
+                int32_t kind;       // MINIJS_INT is folded into MINIJS_NUMBER
+                double num;
+                std::string str;
+            };
+
+            struct Entry {
+                uint64_t hash;
+                std::vector<Arg> args;
+                Value result;
+            };
+
+            explicit MemoCache(size_t cap) : capacity(cap ? cap : 1) {}
+
+            // false for handle kinds (not cacheable)
+            static bool keyOf(const minijs_value& v, int32_t& kind, double& num) {
+                kind = v.kind;
+                num = 0.0;
+                switch (v.kind) {
+                case MINIJS_NULL:   return true;
+                case MINIJS_NUMBER: num = std::isnan(v.num) ? std::numeric_limits<double>::quiet_NaN() : v.num; return true;
+                case MINIJS_INT:    kind = MINIJS_NUMBER; num = (double)v.i32; return true;
+                case MINIJS_BOOL:   num = v.boolean ? 1.0 : 0.0; return true;
+                case MINIJS_STRING: return true;
+                default:            return false;
+                }
+            }
+
+            // FNV-1a over kinds and payloads; false if any argument is not cacheable
+            static bool hashArgs(int argc, const minijs_value* argv, uint64_t& out) {
+                uint64_t h = 1469598103934665603ULL;
+                auto mix = [&h](const void* p, size_t n) {
+                    const unsigned char* c = (const unsigned char*)p;
+                    for (size_t i = 0; i < n; i++) {
+                        h ^= c[i];
+                        h *= 1099511628211ULL;
+                    }
+                };
+                mix(&argc, sizeof(argc));
+                for (int i = 0; i < argc; i++) {
+                    int32_t kind;
+                    double num;
+                    if (!keyOf(argv[i], kind, num)) return false;
+                    mix(&kind, sizeof(kind));
+                    if (kind == MINIJS_STRING) {
+                        const char* str = argv[i].str ? argv[i].str : "";
+                        mix(str, std::strlen(str) + 1);
+                    }
+                    else {
+                        mix(&num, sizeof(num));
+                    }
+                }
+                out = h;
+                return true;
+            }
+
+            static bool sameArgs(const Entry& e, int argc, const minijs_value* argv) {
+                if (e.args.size() != (size_t)argc) return false;
+                for (int i = 0; i < argc; i++) {
+                    int32_t kind;
+                    double num;
+                    if (!keyOf(argv[i], kind, num) || kind != e.args[i].kind) return false;
+                    if (kind == MINIJS_STRING) {
+                        if (e.args[i].str != (argv[i].str ? argv[i].str : "")) return false;
+                    }
+                    else if (std::memcmp(&num, &e.args[i].num, sizeof(num)) != 0) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            const Value* find(uint64_t hash, int argc, const minijs_value* argv) {
+                auto it = index.find(hash);
+                if (it == index.end() || !sameArgs(*it->second, argc, argv)) {
+                    misses++;
+                    return nullptr;
+                }
+                entries.splice(entries.begin(), entries, it->second);
+                hits++;
+                return &entries.front().result;
+            }
+
+            void insert(uint64_t hash, int argc, const minijs_value* argv, const Value& result) {
+                auto it = index.find(hash);
+                if (it != index.end()) {
+                    // hash collision with a different argument list: newest wins
+                    entries.erase(it->second);
+                    index.erase(it);
+                }
+
+                Entry e;
+                e.hash = hash;
+                e.args.reserve((size_t)argc);
+                for (int i = 0; i < argc; i++) {
+                    Arg a;
+                    keyOf(argv[i], a.kind, a.num);
+                    if (a.kind == MINIJS_STRING) a.str = argv[i].str ? argv[i].str : "";
+                    e.args.push_back(std::move(a));
+                }
+                e.result = result;
+                entries.push_front(std::move(e));
+                index[hash] = entries.begin();
+
+                if (entries.size() > capacity) {
+                    index.erase(entries.back().hash);
+                    entries.pop_back();
+                    evictions++;
+                }
+            }
+
+            size_t capacity;
+            std::list<Entry> entries;   // front = most recently used
+            std::unordered_map<uint64_t, std::list<Entry>::iterator> index;
+            std::atomic<uint64_t> hits{ 0 };      // atomics: bindingStats() may run on another thread
+            std::atomic<uint64_t> misses{ 0 };
+            std::atomic<uint64_t> evictions{ 0 };
+        };
+
+        struct CompiledScript {
+            uint64_t key;
+            std::string source;
+            void* script;      // nullptr: source doesn't compile (negative entry)
+        };
+
+        static uint64_t compileKey(const std::string& code) {
+            uint64_t h = (uint64_t)std::hash<std::string_view>()(std::string_view(code));
+            return h ^ ((uint64_t)code.size() * 0x9E3779B97F4A7C15ULL);
+        }
+
+        void evictOldestScript() {
+            CompiledScript& c = _compiled.back();
+            if (c.script) minijs_handle_release(c.script);
+            _compiledIndex.erase(c.key);
+            _compiled.pop_back();
+            _compileEntries = _compiled.size();
+            _compileEvictions++;
+        }
+
+        // Compiled script for code, or nullptr (cache off / syntax error; the
+        // caller then runs the source, which reports the error)
+        void* cachedScript(const std::string& code) {
+            if (_compileCapacity == 0) return nullptr;
+
+            uint64_t key = compileKey(code);
+            auto it = _compiledIndex.find(key);
+            if (it != _compiledIndex.end() && it->second->source == code) {
+                _compiled.splice(_compiled.begin(), _compiled, it->second);
+                _compileHits++;
+                return it->second->script;
+            }
+            _compileMisses++;
+
+            void* script = minijs_compile(_it, code.c_str(), code.size());
+            if (!script) _compileFailures++;
+
+            if (it != _compiledIndex.end()) {
+                // same key, different source: newest wins
+                if (it->second->script) minijs_handle_release(it->second->script);
+                _compiled.erase(it->second);
+                _compiledIndex.erase(it);
+            }
+            _compiled.push_front(CompiledScript{ key, code, script });
+            _compiledIndex[key] = _compiled.begin();
+            while (_compiled.size() > _compileCapacity) evictOldestScript();
+            _compileEntries = _compiled.size();
+            return script;
+        }
+
+        // Plain run() only needs minijs_run, so hosts that never touch the compile
+        // cache or setResultLength still link against a libminijs without them.
+        char* runRaw(const std::string& code, size_t* len) {
+            if (_runCompiled) return _runCompiled(*this, code, len);
+            char* out = minijs_run(_it, code.c_str());
+            *len = out ? std::strlen(out) : 0;
+            return out;
+        }
+
+        static char* runCompiled(Engine& e, const std::string& code, size_t* len) {
+            void* script = e.cachedScript(code);
+            if (script) return minijs_script_run_n(e._it, script, len);
+            return minijs_run_n(e._it, code.c_str(), len);
+        }
+
+        // Callback argument vectors, one per native call depth. Capacity survives
+        // between calls, so steady-state calls don't touch the heap for args.
+        struct ArgFrame {
+            explicit ArgFrame(Engine& e) : engine(e), args(e.acquireArgs()) {}
+            ~ArgFrame() {
+                args.clear();
+                engine._argDepth--;
+            }
+            ArgFrame(const ArgFrame&) = delete;
+            ArgFrame& operator=(const ArgFrame&) = delete;
+
+            Engine& engine;
+            std::vector<Value>& args;
+        };
+
+        std::vector<Value>& acquireArgs() {
+            if (_argDepth == _argStack.size()) _argStack.emplace_back(new std::vector<Value>());
+            return *_argStack[_argDepth++];
+        }
+
         struct Binding {
             Engine* engine;
             Callback cb;
+            std::string name;
+            std::unique_ptr<MemoCache> memo;   // only for FunctionFlags::Pure
+            std::atomic<uint64_t> calls{ 0 };
+            std::atomic<uint64_t> errors{ 0 };
+            std::atomic<uint64_t> nanos{ 0 };   // only counted with setBindingTiming(true)
+            bool fast = false;                  // registerFastFunction (direct calls bypass the trampoline)
         };
 
+        // JS ToNumber for the fast-function fallback (missing argument => NaN)
+        static double coerceNumberArg(const std::vector<Value>& args, size_t i) {
+            if (i >= args.size()) return std::numeric_limits<double>::quiet_NaN();
+            const Value& v = args[i];
+            switch (v.kind()) {
+            case Value::Kind::Null:   return 0.0;
+            case Value::Kind::String: return stringToNumber(v.toStringRef());
+            default:                  return v.toNumber(std::numeric_limits<double>::quiet_NaN());
+            }
+        }
+
+        template <typename Fn, size_t... I>
+        static double callFast(Fn fn, const std::vector<Value>& args, std::index_sequence<I...>) {
+            return fn(coerceNumberArg(args, I)...);
+        }
+
+        static void sinkThunk(const char* data, size_t len, void* userdata) {
+            const Sink* sink = (const Sink*)userdata;
+            try {
+                (*sink)(data, len);
+            }
+            catch (...) {
+                // must not unwind through the runtime; the chunk is lost
+            }
+        }
+
+        static void finalizeThunk(void* userdata) {
+            std::function<void()>* fn = (std::function<void()>*)userdata;
+            try {
+                if (*fn) (*fn)();
+            }
+            catch (...) {
+                // nowhere to report from inside the collector
+            }
+            delete fn;
+        }
+
         static char* allocUtf8WithMinijsMalloc(const std::string& s) {
             void* mem = minijs_malloc(s.size() + 1);
             if (!mem) return nullptr;
@@ -336,6 +1565,40 @@ namespace minijspp {
             return (char*)mem;
         }
 
+        // Convert return:
+        // - primitives: direct
+        // - string: MUST be allocated via minijs_malloc (runtime frees)
+        // - handles: CONSUMED by runtime => detach so we don't double-release
+        static minijs_value toNativeReturn(Value& ret) {
+            minijs_value out{};
+            out.kind = (int32_t)ret.kind();
+            out.num = ret.toNumber();
+            out.boolean = ret.toBool() ? 1 : 0;
+            out.str = nullptr;
+            out.handle = nullptr;
+
+            if (ret.kind() == Value::Kind::String) {
+                out.kind = MINIJS_STRING;
+                out.str = allocUtf8WithMinijsMalloc(ret.toStringRef());
+                return out;
+            }
+
+            if (ret.isHandleKind() && ret.handle()) {
+                out.kind = (int32_t)ret.kind();
+                out.handle = ret.detachHandle(); // transfer ownership
+                return out;
+            }
+
+            // i32 shares its slot with boolean
+            if (ret.kind() == Value::Kind::Int) {
+                out.i32 = ret.toInt32();
+                return out;
+            }
+
+            // number/bool/null
+            return out;
+        }
+
         static minijs_value trampoline(int argc, const minijs_value* argv, const minijs_value* thisVal, void* userdata) {
             Binding* b = (Binding*)userdata;
             if (!b || !b->engine) {
@@ -344,47 +1607,51 @@ namespace minijspp {
                 return r;
             }
 
+            b->calls.fetch_add(1, std::memory_order_relaxed);
+            HandleTracker::Scope trackScope(b->engine->_it); // MINIJSPP_TRACK_HANDLES only
+            bool timed = b->engine->_bindingTiming;
+            std::chrono::steady_clock::time_point t0;
+            if (timed) t0 = std::chrono::steady_clock::now();
+            auto addTime = [&]() {
+                if (!timed) return;
+                auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0).count();
+                b->nanos.fetch_add((uint64_t)ns, std::memory_order_relaxed);
+            };
+
             try {
-                std::vector<Value> args;
+                uint64_t memoHash = 0;
+                bool memoize = b->memo && MemoCache::hashArgs(argc, argv, memoHash);
+                if (memoize) {
+                    const Value* hit = b->memo->find(memoHash, argc, argv);
+                    if (hit) {
+                        Value ret = *hit;
+                        addTime();
+                        return toNativeReturn(ret);
+                    }
+                }
+
+                // reuse a per-depth argument vector (nested calls get their own)
+                ArgFrame frame(*b->engine);
+                std::vector<Value>& args = frame.args;
                 args.reserve((size_t)argc);
                 for (int i = 0; i < argc; i++) {
-                    // retain handle args so our Value destructor can safely release
-                    args.push_back(Value::fromNative(argv[i], /*retainHandle=*/true));
+                    // runtime keeps args alive for the call => borrow, no retain/release pair
+                    args.push_back(Value::fromNativeBorrowed(argv[i]));
                 }
 
                 Value tv = Value::Null();
-                if (thisVal) tv = Value::fromNative(*thisVal, /*retainHandle=*/true);
+                if (thisVal) tv = Value::fromNativeBorrowed(*thisVal);
 
                 Value ret = b->cb(args, tv);
 
-                // Convert return:
-                // - primitives: direct
-                // - string: MUST be allocated via minijs_malloc (runtime frees)
-                // - handles: CONSUMED by runtime => detach so we don't double-release
-                minijs_value out{};
-                out.kind = (int32_t)ret.kind();
-                out.num = ret.toNumber();
-                out.boolean = ret.toBool() ? 1 : 0;
-                out.str = nullptr;
-                out.handle = nullptr;
-
-                if (ret.kind() == Value::Kind::String) {
-                    std::string s = ret.toStringRef();
-                    out.kind = MINIJS_STRING;
-                    out.str = allocUtf8WithMinijsMalloc(s);
-                    return out;
-                }
+                if (memoize && !ret.isHandleKind()) b->memo->insert(memoHash, argc, argv, ret);
 
-                if (ret.isHandleKind() && ret.handle()) {
-                    out.kind = (int32_t)ret.kind();
-                    out.handle = ret.detachHandle(); // transfer ownership
-                    return out;
-                }
-
-                // number/bool/null
-                return out;
+                addTime();
+                return toNativeReturn(ret);
             }
             catch (const std::exception& e) {
+                addTime();
+                b->errors.fetch_add(1, std::memory_order_relaxed);
                 minijs_value out{};
                 out.kind = MINIJS_STRING;
                 std::string msg = std::string("Error: ") + e.what();
@@ -392,6 +1659,8 @@ namespace minijspp {
                 return out;
             }
             catch (...) {
+                addTime();
+                b->errors.fetch_add(1, std::memory_order_relaxed);
                 minijs_value out{};
                 out.kind = MINIJS_STRING;
                 std::string msg = "Error: unknown native exception";
@@ -402,37 +1671,98 @@ namespace minijspp {
 
         void* _it;
         std::vector<Binding*> _bindings;
+        std::vector<std::unique_ptr<Binding[]>> _modules;
+        std::vector<size_t> _moduleSizes;
+        std::vector<std::unique_ptr<std::vector<Value>>> _argStack;
+        std::string _resultBuf;                // run(code, out) scratch, never shrinks
+        size_t _argDepth = 0;
+        std::list<CompiledScript> _compiled;   // front = most recently used
+        std::unordered_map<uint64_t, std::list<CompiledScript>::iterator> _compiledIndex;
+        std::atomic<size_t> _compileCapacity{ 0 };
+        char* (*_runCompiled)(Engine&, const std::string&, size_t*) = nullptr; // set by setCompileCacheCapacity / setResultLength
+        bool _resultLength = false;
+        std::atomic<size_t> _compileEntries{ 0 };
+        std::atomic<uint64_t> _compileHits{ 0 };
+        std::atomic<uint64_t> _compileMisses{ 0 };
+        std::atomic<uint64_t> _compileFailures{ 0 };
+        std::atomic<uint64_t> _compileEvictions{ 0 };
+        bool _bindingTiming = false;
+        uint64_t _fuel = 0;
     };
 
     // ------------------------------------------------------------
+    // Request-scoped allocation for the calls that take a memory_resource:
+    // run(code, mr), ObjectRef::keys(mr), getString(..., mr) on Object/Array/Map
+    // and Set::values(mr). What they allocate from resource() is dropped at once
+    // when the arena dies. Value's own string and callback args still use the
+    // global heap; read strings through getString(..., mr) to keep them out.
+    //   minijspp::RequestArena<> arena;
+    //   auto keys = obj.keys(arena.resource());
+    //   std::pmr::string name = obj.getString("name", arena.resource());
+    //   std::pmr::string out = js.run(code, arena.resource());
+    // ------------------------------------------------------------
+    template <size_t InlineBytes = 4096>
+    class RequestArena {
+    public:
+        explicit RequestArena(std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+            : _mr(_buf, sizeof(_buf), upstream) {}
+
+        RequestArena(const RequestArena&) = delete;
+        RequestArena& operator=(const RequestArena&) = delete;
+
+        std::pmr::memory_resource* resource() { return &_mr; }
 
-    class Object {
+        // Drop everything now (objects allocated from resource() must be dead)
+        void release() { _mr.release(); }
+
+    private:
+        alignas(std::max_align_t) unsigned char _buf[InlineBytes];
+        std::pmr::monotonic_buffer_resource _mr;
+    };
+
+    // ------------------------------------------------------------
+
+    // Borrowed (non-retaining) view of an object handle, e.g. thisVal inside a
+    // callback. Valid only while someone else keeps the object alive.
+    class ObjectRef {
     public:
-        Object() : _v(Value::Null()) {}
-        explicit Object(Value v) : _v(std::move(v)) {
-            if (_v.kind() != Value::Kind::Object) throw std::runtime_error("Object: Value is not an object");
-        }
+        ObjectRef() : _h(nullptr) {}
+        explicit ObjectRef(void* h) : _h(h) {}
 
-        void* handle() const { return _v.handle(); }
+        void* handle() const { return _h; }
 
         bool has(const std::string& key) const {
             if (!handle()) return false;
             return minijs_object_has(handle(), key.c_str()) != 0;
         }
 
-        Value get(const std::string& key) const {
+        Value get(const std::string& key, HandleSite site = HandleSite::current()) const {
             if (!handle()) return Value::Null();
             minijs_value out{};
             minijs_object_get(handle(), key.c_str(), &out);
 
             // object_get may return malloc'ed string => free after copy
-            Value v = Value::fromNative(out, /*retainHandle=*/false);
+            Value v = Value::fromNative(out, /*retainHandle=*/false, site.in(HandleTracker::engineOf(handle())));
             if ((Value::Kind)out.kind == Value::Kind::String && out.str) {
                 minijs_free((void*)out.str);
             }
             return v;
         }
 
+        // String form of the property, allocated from mr ("" for handles / missing)
+        std::pmr::string getString(const std::string& key, std::pmr::memory_resource* mr) const {
+            if (!handle()) return std::pmr::string(mr);
+            minijs_value out{};
+            minijs_object_get(handle(), key.c_str(), &out);
+            return Value::stringFromNativeOwned(out, mr);
+        }
+
+        // Object.freeze, recursively (per engine; see SharedValue for cross-engine)
+        void freezeDeep() {
+            if (!handle()) throw std::runtime_error("Object::freezeDeep on null handle");
+            minijs_freeze_deep(handle());
+        }
+
         void set(Engine& e, const std::string& key, const Value& v) {
             if (!handle()) throw std::runtime_error("Object::set on null handle");
             char* tmp = nullptr;
@@ -443,23 +1773,39 @@ namespace minijspp {
 
         std::vector<std::string> keys() const {
             std::vector<std::string> res;
-            if (!handle()) return res;
+            readKeys(res);
+            return res;
+        }
 
-            char* json = minijs_object_keys(handle());
-            if (!json) return res;
+        // Same, but vector and strings come from mr (e.g. a RequestArena)
+        std::pmr::vector<std::pmr::string> keys(std::pmr::memory_resource* mr) const {
+            std::pmr::vector<std::pmr::string> res(mr);
+            readKeys(res);
+            return res;
+        }
+
+    protected:
+        template <typename Vec>
+        void readKeys(Vec& res) const {
+            if (!handle()) return;
 
-            // Very small parser for ["a","b"] (enough for keys())
-            // Not a general JSON parser.
-            std::string s(json);
+            char* json = minijs_object_keys(handle());
+            if (!json) return;
+            parseKeys(std::string_view(json), res);
             minijs_free(json);
+        }
 
+        // Very small parser for ["a","b"] (enough for keys())
+        // Not a general JSON parser.
+        template <typename Vec>
+        static void parseKeys(std::string_view s, Vec& res) {
             size_t i = 0;
             auto skipws = [&]() {
                 while (i < s.size() && (s[i] == ' ' || s[i] == '\t' || s[i] == '\r' || s[i] == '\n')) i++;
                 };
 
             skipws();
-            if (i >= s.size() || s[i] != '[') return res;
+            if (i >= s.size() || s[i] != '[') return;
             i++;
             skipws();
 
@@ -470,7 +1816,7 @@ namespace minijspp {
                 if (i >= s.size() || s[i] != '"') break;
                 i++;
 
-                std::string cur;
+                typename Vec::value_type cur(res.get_allocator());
                 while (i < s.size()) {
                     char c = s[i++];
                     if (c == '"') break;
@@ -489,14 +1835,37 @@ namespace minijspp {
                         cur.push_back(c);
                     }
                 }
-                res.push_back(cur);
+                res.push_back(std::move(cur));
 
                 skipws();
                 if (i < s.size() && s[i] == ',') { i++; continue; }
                 skipws();
                 if (i < s.size() && s[i] == ']') break;
             }
-            return res;
+        }
+
+        void* _h;
+    };
+
+    // Owning object (retains its handle)
+    class Object : public ObjectRef {
+    public:
+        Object() : _v(Value::Null()) {}
+        explicit Object(Value v) : ObjectRef(v.handle()), _v(std::move(v)) {
+            if (_v.kind() != Value::Kind::Object) throw std::runtime_error("Object: Value is not an object");
+        }
+
+        Object(const Object&) = default;
+        Object& operator=(const Object&) = default;
+
+        Object(Object&& o) noexcept : ObjectRef(o._h), _v(std::move(o._v)) { o._h = nullptr; }
+
+        Object& operator=(Object&& o) noexcept {
+            if (this == &o) return *this;
+            _v = std::move(o._v);
+            _h = o._h;
+            o._h = nullptr;
+            return *this;
         }
 
     private:
@@ -505,32 +1874,45 @@ namespace minijspp {
 
     // ------------------------------------------------------------
 
-    class Array {
+    // Borrowed (non-retaining) view of an array handle
+    class ArrayRef {
     public:
-        Array() : _v(Value::Null()) {}
-        explicit Array(Value v) : _v(std::move(v)) {
-            if (_v.kind() != Value::Kind::Array) throw std::runtime_error("Array: Value is not an array");
-        }
+        enum class ElementsKind : int32_t {
+            Int32 = MINIJS_ELEMENTS_INT32,
+            Double = MINIJS_ELEMENTS_DOUBLE,
+            Generic = MINIJS_ELEMENTS_GENERIC
+        };
 
-        void* handle() const { return _v.handle(); }
+        ArrayRef() : _h(nullptr) {}
+        explicit ArrayRef(void* h) : _h(h) {}
+
+        void* handle() const { return _h; }
 
         int32_t length() const {
             if (!handle()) return 0;
             return minijs_array_length(handle());
         }
 
-        Value get(int32_t index) const {
+        Value get(int32_t index, HandleSite site = HandleSite::current()) const {
             if (!handle()) return Value::Null();
             minijs_value out{};
             minijs_array_get(handle(), index, &out);
 
-            Value v = Value::fromNative(out, /*retainHandle=*/false);
+            Value v = Value::fromNative(out, /*retainHandle=*/false, site.in(HandleTracker::engineOf(handle())));
             if ((Value::Kind)out.kind == Value::Kind::String && out.str) {
                 minijs_free((void*)out.str);
             }
             return v;
         }
 
+        // String form of the element, allocated from mr
+        std::pmr::string getString(int32_t index, std::pmr::memory_resource* mr) const {
+            if (!handle()) return std::pmr::string(mr);
+            minijs_value out{};
+            minijs_array_get(handle(), index, &out);
+            return Value::stringFromNativeOwned(out, mr);
+        }
+
         void set(Engine& e, int32_t index, const Value& v) {
             if (!handle()) throw std::runtime_error("Array::set on null handle");
             char* tmp = nullptr;
@@ -547,28 +1929,233 @@ namespace minijspp {
             if (tmp) minijs_free(tmp);
         }
 
+        // Storage specialization currently used by the runtime (debug/stats)
+        ElementsKind elementsKind() const {
+            if (!handle()) return ElementsKind::Generic;
+            return (ElementsKind)minijs_array_elements_kind(handle());
+        }
+
+        void reserve(int32_t capacity) {
+            if (!handle()) throw std::runtime_error("Array::reserve on null handle");
+            minijs_array_reserve(handle(), capacity);
+        }
+
+        // Bulk numeric push/read: one ABI call, no per-element minijs_value
+        void pushNumbers(const double* values, int32_t count) {
+            if (!handle()) throw std::runtime_error("Array::pushNumbers on null handle");
+            if (count <= 0) return;
+            minijs_array_push_numbers(handle(), values, count);
+        }
+
+        void pushNumbers(const std::vector<double>& values) {
+            pushNumbers(values.data(), (int32_t)values.size());
+        }
+
+        // Reads numbers from start; result is shorter if a non-number is hit
+        std::vector<double> getNumbers(int32_t start = 0, int32_t count = -1) const {
+            std::vector<double> res;
+            if (!handle()) return res;
+            int32_t len = length();
+            if (start < 0 || start >= len) return res;
+            if (count < 0 || count > len - start) count = len - start;
+            res.resize((size_t)count);
+            int32_t n = minijs_array_get_numbers(handle(), start, res.data(), count);
+            res.resize((size_t)(n > 0 ? n : 0));
+            return res;
+        }
+
+        // Vectorized reductions; def is returned for empty or non-numeric arrays
+        double sum(double def = 0.0) const { return reduce(MINIJS_REDUCE_SUM, def); }
+        double min(double def = 0.0) const { return reduce(MINIJS_REDUCE_MIN, def); }
+        double max(double def = 0.0) const { return reduce(MINIJS_REDUCE_MAX, def); }
+
+        double dot(const ArrayRef& other, double def = 0.0) const {
+            if (!handle() || !other.handle()) return def;
+            double out = def;
+            if (!minijs_array_dot(handle(), other.handle(), &out)) return def;
+            return out;
+        }
+
+        int32_t indexOf(double needle, int32_t fromIndex = 0) const {
+            if (!handle()) return -1;
+            return minijs_array_index_of_number(handle(), needle, fromIndex);
+        }
+
+        // Fills [start, end); end < 0 means length()
+        void fill(double value, int32_t start = 0, int32_t end = -1) {
+            if (!handle()) throw std::runtime_error("Array::fill on null handle");
+            if (end < 0) end = length();
+            minijs_array_fill_number(handle(), value, start, end);
+        }
+
+    private:
+        double reduce(int32_t op, double def) const {
+            if (!handle() || length() == 0) return def;
+            double out = def;
+            if (!minijs_array_reduce_numbers(handle(), op, &out)) return def;
+            return out;
+        }
+
+    protected:
+        void* _h;
+    };
+
+    // Owning array (retains its handle)
+    class Array : public ArrayRef {
+    public:
+        Array() : _v(Value::Null()) {}
+        explicit Array(Value v) : ArrayRef(v.handle()), _v(std::move(v)) {
+            if (_v.kind() != Value::Kind::Array) throw std::runtime_error("Array: Value is not an array");
+        }
+
+        Array(const Array&) = default;
+        Array& operator=(const Array&) = default;
+
+        Array(Array&& o) noexcept : ArrayRef(o._h), _v(std::move(o._v)) { o._h = nullptr; }
+
+        Array& operator=(Array&& o) noexcept {
+            if (this == &o) return *this;
+            _v = std::move(o._v);
+            _h = o._h;
+            o._h = nullptr;
+            return *this;
+        }
+
     private:
         Value _v;
     };
 
     // ------------------------------------------------------------
 
-    class Function {
+    // Borrowed (non-retaining) view of a function handle
+    class FunctionRef {
+    public:
+        FunctionRef() : _h(nullptr) {}
+        explicit FunctionRef(void* h) : _h(h) {}
+
+        void* handle() const { return _h; }
+
+    protected:
+        void* _h;
+    };
+
+    // Owning function (retains its handle)
+    class Function : public FunctionRef {
     public:
         Function() : _v(Value::Null()) {}
-        explicit Function(Value v) : _v(std::move(v)) {
+        explicit Function(Value v) : FunctionRef(v.handle()), _v(std::move(v)) {
             if (_v.kind() != Value::Kind::Function) throw std::runtime_error("Function: Value is not a function");
         }
 
-        void* handle() const { return _v.handle(); }
+        Function(const Function&) = default;
+        Function& operator=(const Function&) = default;
+
+        Function(Function&& o) noexcept : FunctionRef(o._h), _v(std::move(o._v)) { o._h = nullptr; }
+
+        Function& operator=(Function&& o) noexcept {
+            if (this == &o) return *this;
+            _v = std::move(o._v);
+            _h = o._h;
+            o._h = nullptr;
+            return *this;
+        }
 
         // Transfer ownership to runtime (consumed)
-        void* detachHandle() { return _v.detachHandle(); }
+        void* detachHandle() {
+            _h = nullptr;
+            return _v.detachHandle();
+        }
 
     private:
         Value _v;
     };
 
+    // ------------------------------------------------------------
+    // Move-only owner of exactly one handle reference. Moving never touches
+    // the refcount (unlike Value copies, which retain across the FFI).
+    // ------------------------------------------------------------
+
+    template <Value::Kind K> struct HandleRef {};
+    template <> struct HandleRef<Value::Kind::Object> { using type = ObjectRef; };
+    template <> struct HandleRef<Value::Kind::Array> { using type = ArrayRef; };
+    template <> struct HandleRef<Value::Kind::Function> { using type = FunctionRef; };
+
+    template <Value::Kind K>
+    class UniqueHandle : private TrackedRef {
+    public:
+        UniqueHandle() : _h(nullptr) {}
+        // Adopts an already owned reference (e.g. from *_create or *_get)
+        explicit UniqueHandle(void* adopted, HandleSite site = HandleSite::current()) : _h(adopted) {
+            if (_h) track(_h, (int32_t)K, site);
+        }
+
+        static UniqueHandle retain(void* h, HandleSite site = HandleSite::current()) {
+            if (h) minijs_handle_retain(h);
+            return UniqueHandle(h, site);
+        }
+
+        ~UniqueHandle() { drop(); }
+
+        UniqueHandle(const UniqueHandle&) = delete;
+        UniqueHandle& operator=(const UniqueHandle&) = delete;
+
+        UniqueHandle(UniqueHandle&& o) noexcept : _h(o._h) {
+            takeTicket(o);
+            o._h = nullptr;
+        }
+
+        UniqueHandle& operator=(UniqueHandle&& o) noexcept {
+            if (this == &o) return *this;
+            drop();
+            _h = o._h;
+            takeTicket(o);
+            o._h = nullptr;
+            return *this;
+        }
+
+        void* get() const { return _h; }
+        explicit operator bool() const { return _h != nullptr; }
+
+        void reset(void* adopted = nullptr, HandleSite site = HandleSite::current()) {
+            drop();
+            _h = adopted;
+            if (_h) track(_h, (int32_t)K, site);
+        }
+
+        // Give the reference away (to a consuming API)
+        void* detachHandle() {
+            void* h = _h;
+            if (h) untrack(h);
+            _h = nullptr;
+            return h;
+        }
+
+        Value toValue(HandleSite site = HandleSite::current()) && {
+            void* engine = HandleTracker::engineOf(_h);
+            return Value::Handle(K, detachHandle(), /*retain=*/false, site.in(engine));
+        }
+
+        // Borrowed typed view (ObjectRef / ArrayRef / FunctionRef)
+        template <Value::Kind KK = K>
+        typename HandleRef<KK>::type ref() const { return typename HandleRef<KK>::type(_h); }
+
+    private:
+        void drop() {
+            if (!_h) return;
+            untrack(_h);
+            minijs_handle_release(_h);
+            _h = nullptr;
+        }
+
+        void* _h;
+    };
+
+    using UniqueObject = UniqueHandle<Value::Kind::Object>;
+    using UniqueArray = UniqueHandle<Value::Kind::Array>;
+    using UniqueFunction = UniqueHandle<Value::Kind::Function>;
+
+    // ------------------------------------------------------------
+
     class Class {
     public:
         Class() : _v(Value::Null()) {}
@@ -592,42 +2179,430 @@ namespace minijspp {
         Value _v;
     };
 
+    // ------------------------------------------------------------
+
+    // Non-owning reference to a script object; lock() yields a strong Value
+    // while the object is alive, Null afterwards. Move-only.
+    class WeakRef {
+    public:
+        WeakRef() : _kind(Value::Kind::Null), _w(nullptr), _engine(nullptr) {}
+
+        explicit WeakRef(const Value& v) : _kind(v.kind()), _w(nullptr), _engine(HandleTracker::engineOf(v.handle())) {
+            if (!v.isHandleKind() || !v.handle()) throw std::runtime_error("WeakRef: value has no handle");
+            _w = minijs_weak_create(v.handle());
+            if (!_w) throw std::runtime_error("minijs_weak_create failed");
+        }
+
+        ~WeakRef() {
+            if (_w) minijs_weak_release(_w);
+        }
+
+        WeakRef(const WeakRef&) = delete;
+        WeakRef& operator=(const WeakRef&) = delete;
+
+        WeakRef(WeakRef&& o) noexcept : _kind(o._kind), _w(o._w), _engine(o._engine) { o._w = nullptr; }
+
+        WeakRef& operator=(WeakRef&& o) noexcept {
+            if (this == &o) return *this;
+            if (_w) minijs_weak_release(_w);
+            _kind = o._kind;
+            _w = o._w;
+            _engine = o._engine;
+            o._w = nullptr;
+            return *this;
+        }
+
+        Value lock(HandleSite site = HandleSite::current()) const {
+            if (!_w) return Value::Null();
+            void* h = minijs_weak_get(_w);
+            if (!h) return Value::Null();
+            return Value::Handle(_kind, h, /*retain=*/false, site.in(_engine));
+        }
+
+        bool expired() const { return lock().kind() == Value::Kind::Null; }
+
+    private:
+        Value::Kind _kind;
+        void* _w;
+        void* _engine;   // owning engine as the handle tracker knows it (nullptr without tracking)
+    };
+
+    // ------------------------------------------------------------
+
+    // Immutable deep copy that any number of engines (on any thread) can
+    // declare by reference. Copying only bumps an atomic refcount.
+    class SharedValue {
+    public:
+        SharedValue() : _h(nullptr) {}
+
+        static SharedValue create(const Value& v) {
+            minijs_value nv = Engine::valueToNativeArg(v, nullptr);
+            void* h = minijs_shared_create(&nv);
+            if (!h) throw std::runtime_error("minijs_shared_create failed");
+            SharedValue s;
+            s._h = h;
+            return s;
+        }
+
+        ~SharedValue() {
+            if (_h) minijs_shared_release(_h);
+        }
+
+        SharedValue(const SharedValue& o) : _h(o._h) {
+            if (_h) minijs_shared_retain(_h);
+        }
+
+        SharedValue& operator=(const SharedValue& o) {
+            if (this == &o) return *this;
+            if (o._h) minijs_shared_retain(o._h);
+            if (_h) minijs_shared_release(_h);
+            _h = o._h;
+            return *this;
+        }
+
+        SharedValue(SharedValue&& o) noexcept : _h(o._h) { o._h = nullptr; }
+
+        SharedValue& operator=(SharedValue&& o) noexcept {
+            if (this == &o) return *this;
+            if (_h) minijs_shared_release(_h);
+            _h = o._h;
+            o._h = nullptr;
+            return *this;
+        }
+
+        void* handle() const { return _h; }
+
+        size_t bytes() const { return _h ? minijs_shared_bytes(_h) : 0; }
+
+    private:
+        void* _h;
+    };
+
+    // ------------------------------------------------------------
+
+    // Declares a field list once; create() builds same-shaped objects in one call.
+    // Owns the template handle (move-only).
+    class ObjectTemplate : private TrackedRef {
+    public:
+        ObjectTemplate() : _h(nullptr) {}
+        ObjectTemplate(void* h, std::vector<std::string> keys, HandleSite site = HandleSite::current()) : _h(h), _keys(std::move(keys)) {
+            if (_h) track(_h, -1, site);
+        }
+
+        ~ObjectTemplate() { drop(); }
+
+        ObjectTemplate(const ObjectTemplate&) = delete;
+        ObjectTemplate& operator=(const ObjectTemplate&) = delete;
+
+        ObjectTemplate(ObjectTemplate&& o) noexcept : _h(o._h), _keys(std::move(o._keys)) {
+            takeTicket(o);
+            o._h = nullptr;
+        }
+
+        ObjectTemplate& operator=(ObjectTemplate&& o) noexcept {
+            if (this == &o) return *this;
+            drop();
+            _h = o._h;
+            _keys = std::move(o._keys);
+            takeTicket(o);
+            o._h = nullptr;
+            return *this;
+        }
+
+        void* handle() const { return _h; }
+        const std::vector<std::string>& keys() const { return _keys; }
+        int32_t fieldCount() const { return (int32_t)_keys.size(); }
+
+        // values in keys() order
+        Object create(const std::vector<Value>& values, HandleSite site = HandleSite::current()) const;
+
+        // values is rows * fieldCount() entries, row-major; objects are pushed onto arr
+        void createMany(const ArrayRef& arr, const std::vector<Value>& values) const {
+            if (!_h) throw std::runtime_error("ObjectTemplate::createMany on null handle");
+            if (!arr.handle()) throw std::runtime_error("ObjectTemplate::createMany on null array");
+            size_t n = _keys.size();
+            if (n == 0 || values.size() % n != 0) throw std::runtime_error("ObjectTemplate::createMany: value count is not a multiple of fieldCount()");
+
+            std::vector<minijs_value> nv(values.size());
+            for (size_t i = 0; i < values.size(); i++) nv[i] = Engine::valueToNativeArg(values[i], nullptr);
+            minijs_objects_from_template(_h, nv.data(), (int32_t)(values.size() / n), arr.handle());
+        }
+
+    private:
+        void drop() {
+            if (!_h) return;
+            untrack(_h);
+            minijs_handle_release(_h);
+            _h = nullptr;
+        }
+
+        void* _h;
+        std::vector<std::string> _keys;
+    };
+
+    // ------------------------------------------------------------
+
+    // Keys and values may be any Value (SameValueZero, like script-side Map)
+    class Map {
+    public:
+        Map() : _v(Value::Null()) {}
+        explicit Map(Value v) : _v(std::move(v)) {
+            if (_v.kind() != Value::Kind::Map) throw std::runtime_error("Map: Value is not a map");
+        }
+
+        void* handle() const { return _v.handle(); }
+
+        int32_t size() const {
+            if (!handle()) return 0;
+            return minijs_map_size(handle());
+        }
+
+        bool has(const Value& key) const {
+            if (!handle()) return false;
+            minijs_value nk = Engine::valueToNativeArg(key, nullptr);
+            return minijs_map_has(handle(), &nk) != 0;
+        }
+
+        Value get(const Value& key, HandleSite site = HandleSite::current()) const {
+            if (!handle()) return Value::Null();
+            minijs_value nk = Engine::valueToNativeArg(key, nullptr);
+            minijs_value out{};
+            minijs_map_get(handle(), &nk, &out);
+            return Value::fromNativeOwned(out, site.in(HandleTracker::engineOf(handle())));
+        }
+
+        // String form of the value stored under key, allocated from mr
+        std::pmr::string getString(const Value& key, std::pmr::memory_resource* mr) const {
+            if (!handle()) return std::pmr::string(mr);
+            minijs_value nk = Engine::valueToNativeArg(key, nullptr);
+            minijs_value out{};
+            minijs_map_get(handle(), &nk, &out);
+            return Value::stringFromNativeOwned(out, mr);
+        }
+
+        void set(Engine& e, const Value& key, const Value& v) {
+            if (!handle()) throw std::runtime_error("Map::set on null handle");
+            minijs_value nk = e.valueToNativeArg(key, nullptr);
+            minijs_value nv = e.valueToNativeArg(v, nullptr);
+            minijs_map_set(handle(), &nk, &nv);
+        }
+
+        bool remove(const Value& key) {
+            if (!handle()) return false;
+            minijs_value nk = Engine::valueToNativeArg(key, nullptr);
+            return minijs_map_delete(handle(), &nk) != 0;
+        }
+
+        void clear() {
+            if (handle()) minijs_map_clear(handle());
+        }
+
+        // fn(key, value) in insertion order
+        void forEach(const std::function<void(const Value&, const Value&)>& fn, HandleSite site = HandleSite::current()) const {
+            if (!handle()) return;
+            HandleSite owned = site.in(HandleTracker::engineOf(handle()));
+            int32_t cursor = 0;
+            minijs_value k{}, v{};
+            while (minijs_map_next(handle(), &cursor, &k, &v)) {
+                Value key = Value::fromNativeOwned(k, owned);
+                Value val = Value::fromNativeOwned(v, owned);
+                fn(key, val);
+                k = minijs_value{};
+                v = minijs_value{};
+            }
+        }
+
+    private:
+        Value _v;
+    };
+
+    class Set {
+    public:
+        Set() : _v(Value::Null()) {}
+        explicit Set(Value v) : _v(std::move(v)) {
+            if (_v.kind() != Value::Kind::Set) throw std::runtime_error("Set: Value is not a set");
+        }
+
+        void* handle() const { return _v.handle(); }
+
+        int32_t size() const {
+            if (!handle()) return 0;
+            return minijs_set_size(handle());
+        }
+
+        bool has(const Value& v) const {
+            if (!handle()) return false;
+            minijs_value nv = Engine::valueToNativeArg(v, nullptr);
+            return minijs_set_has(handle(), &nv) != 0;
+        }
+
+        void add(Engine& e, const Value& v) {
+            if (!handle()) throw std::runtime_error("Set::add on null handle");
+            minijs_value nv = e.valueToNativeArg(v, nullptr);
+            minijs_set_add(handle(), &nv);
+        }
+
+        bool remove(const Value& v) {
+            if (!handle()) return false;
+            minijs_value nv = Engine::valueToNativeArg(v, nullptr);
+            return minijs_set_delete(handle(), &nv) != 0;
+        }
+
+        void clear() {
+            if (handle()) minijs_set_clear(handle());
+        }
+
+        // Insertion order
+        std::vector<Value> values(HandleSite site = HandleSite::current()) const {
+            std::vector<Value> res;
+            if (!handle()) return res;
+            res.reserve((size_t)size());
+            HandleSite owned = site.in(HandleTracker::engineOf(handle()));
+            int32_t cursor = 0;
+            minijs_value out{};
+            while (minijs_set_next(handle(), &cursor, &out)) {
+                res.push_back(Value::fromNativeOwned(out, owned));
+                out = minijs_value{};
+            }
+            return res;
+        }
+
+        // Same, vector storage from mr (string members of the Values stay on the heap)
+        std::pmr::vector<Value> values(std::pmr::memory_resource* mr, HandleSite site = HandleSite::current()) const {
+            std::pmr::vector<Value> res(mr);
+            if (!handle()) return res;
+            res.reserve((size_t)size());
+            HandleSite owned = site.in(HandleTracker::engineOf(handle()));
+            int32_t cursor = 0;
+            minijs_value out{};
+            while (minijs_set_next(handle(), &cursor, &out)) {
+                res.push_back(Value::fromNativeOwned(out, owned));
+                out = minijs_value{};
+            }
+            return res;
+        }
+
+        // String forms of all members, strings and vector from mr
+        std::pmr::vector<std::pmr::string> valueStrings(std::pmr::memory_resource* mr) const {
+            std::pmr::vector<std::pmr::string> res(mr);
+            if (!handle()) return res;
+            res.reserve((size_t)size());
+            int32_t cursor = 0;
+            minijs_value out{};
+            while (minijs_set_next(handle(), &cursor, &out)) {
+                res.push_back(Value::stringFromNativeOwned(out, mr));
+                out = minijs_value{};
+            }
+            return res;
+        }
+
+    private:
+        Value _v;
+    };
+
     // ------------------------------------------------------------
     // Engine helpers (need class definitions above)
     // ------------------------------------------------------------
 
-    inline Function Engine::createFunction(Callback cb) {
+    inline Function Engine::createFunction(Callback cb, const std::string& name, HandleSite site) {
         Binding* b = new Binding();
         b->engine = this;
         b->cb = std::move(cb);
+        b->name = name;
         _bindings.push_back(b);
 
         void* h = minijs_function_create_native(&Engine::trampoline, b);
         if (!h) throw std::runtime_error("minijs_function_create_native failed");
 
-        Value v = Value::Handle(Value::Kind::Function, h, /*retain=*/false);
+        Value v = Value::Handle(Value::Kind::Function, h, /*retain=*/false, site.in(_it));
         return Function(std::move(v));
     }
 
-    inline Class Engine::createClass(const std::string& name) {
+    inline Class Engine::createClass(const std::string& name, HandleSite site) {
         void* h = minijs_class_create(_it, name.c_str());
         if (!h) throw std::runtime_error("minijs_class_create failed");
-        Value v = Value::Handle(Value::Kind::Class, h, /*retain=*/false);
+        Value v = Value::Handle(Value::Kind::Class, h, /*retain=*/false, site.in(_it));
         return Class(std::move(v));
     }
 
-    inline Object Engine::createObject() {
+    inline Object Engine::createObject(HandleSite site) {
         void* h = minijs_object_create();
         if (!h) throw std::runtime_error("minijs_object_create failed");
-        Value v = Value::Handle(Value::Kind::Object, h, /*retain=*/false);
+        Value v = Value::Handle(Value::Kind::Object, h, /*retain=*/false, site.in(_it));
         return Object(std::move(v));
     }
 
-    inline Array Engine::createArray() {
+    inline Array Engine::createArray(HandleSite site) {
         void* h = minijs_array_create();
         if (!h) throw std::runtime_error("minijs_array_create failed");
-        Value v = Value::Handle(Value::Kind::Array, h, /*retain=*/false);
+        Value v = Value::Handle(Value::Kind::Array, h, /*retain=*/false, site.in(_it));
         return Array(std::move(v));
     }
 
+    inline Map Engine::createMap(HandleSite site) {
+        void* h = minijs_map_create();
+        if (!h) throw std::runtime_error("minijs_map_create failed");
+        Value v = Value::Handle(Value::Kind::Map, h, /*retain=*/false, site.in(_it));
+        return Map(std::move(v));
+    }
+
+    inline Set Engine::createSet(HandleSite site) {
+        void* h = minijs_set_create();
+        if (!h) throw std::runtime_error("minijs_set_create failed");
+        Value v = Value::Handle(Value::Kind::Set, h, /*retain=*/false, site.in(_it));
+        return Set(std::move(v));
+    }
+
+    inline ObjectTemplate Engine::createObjectTemplate(const std::vector<std::string>& keys, HandleSite site) {
+        std::vector<const char*> ckeys;
+        ckeys.reserve(keys.size());
+        for (const std::string& k : keys) ckeys.push_back(k.c_str());
+
+        void* h = minijs_template_create(ckeys.data(), (int32_t)ckeys.size());
+        if (!h) throw std::runtime_error("minijs_template_create failed");
+        return ObjectTemplate(h, keys, site.in(_it));
+    }
+
+    inline Object ObjectTemplate::create(const std::vector<Value>& values, HandleSite site) const {
+        if (!_h) throw std::runtime_error("ObjectTemplate::create on null handle");
+        if (values.size() != _keys.size()) throw std::runtime_error("ObjectTemplate::create: value count does not match fieldCount()");
+
+        std::vector<minijs_value> nv(values.size());
+        for (size_t i = 0; i < values.size(); i++) nv[i] = Engine::valueToNativeArg(values[i], nullptr);
+
+        void* h = minijs_object_from_template(_h, nv.data(), (int32_t)nv.size());
+        if (!h) throw std::runtime_error("minijs_object_from_template failed");
+        Value v = Value::Handle(Value::Kind::Object, h, /*retain=*/false, site.in(HandleTracker::engineOf(_h)));
+        return Object(std::move(v));
+    }
+
+    inline void Engine::declareShared(const std::string& name, const SharedValue& v) {
+        if (!v.handle()) throw std::runtime_error("declareShared: null shared value");
+        minijs_shared_declare(_it, name.c_str(), v.handle());
+    }
+
 } // namespace minijspp
+
+// ------------------------------------------------------------
+// Value as key in std::unordered_map / unordered_set
+// ------------------------------------------------------------
+namespace std {
+    template <>
+    struct hash<minijspp::Value> {
+        size_t operator()(const minijspp::Value& v) const {
+            using Kind = minijspp::Value::Kind;
+            if (v.isNumber()) {
+                double d = v.toNumber();
+                if (d == 0.0) d = 0.0;                                  // -0 => +0
+                if (std::isnan(d)) d = std::numeric_limits<double>::quiet_NaN();
+                return std::hash<double>()(d);
+            }
+            switch (v.kind()) {
+            case Kind::Null:   return 0;
+            case Kind::Bool:   return v.toBool() ? 1 : 2;
+            case Kind::String: return std::hash<std::string>()(v.toStringRef());
+            default:           return std::hash<uint64_t>()(v.identity());
+            }
+        }
+    };
+}
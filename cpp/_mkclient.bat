@@ -1,4 +1,10 @@
 REM Using the API
+REM main.cpp, arrbench.cpp and fuelbench.cpp need a libminijs with the extended API (Api.h);
+REM hosts using only run/register/create* still link against older builds.
 g++ main.cpp -static-libgcc -static-libstdc++ -I. -L. -lminijs -o test.exe
+g++ -O2 heapstat.cpp -static-libgcc -static-libstdc++ -o heapstat.exe
+g++ -O2 numbench.cpp -static-libgcc -static-libstdc++ -I. -o numbench.exe
+g++ -O2 arrbench.cpp -static-libgcc -static-libstdc++ -I. -L. -lminijs -o arrbench.exe
+g++ -O2 fuelbench.cpp -static-libgcc -static-libstdc++ -I. -L. -lminijs -o fuelbench.exe
 
 pause
\ No newline at end of file
@@ -1 +1,7 @@
-g++ main.cpp -L. -lminijs -Wl,-rpath,'$ORIGIN' -o app
\ No newline at end of file
+# main.cpp, arrbench.cpp and fuelbench.cpp need a libminijs with the extended API (Api.h);
+# hosts using only run/register/create* still link against older builds.
+g++ main.cpp -pthread -L. -lminijs -Wl,-rpath,'$ORIGIN' -o app
+g++ -O2 heapstat.cpp -o heapstat
+g++ -O2 -I. numbench.cpp -o numbench
+g++ -O2 -I. arrbench.cpp -L. -lminijs -Wl,-rpath,'$ORIGIN' -o arrbench
+g++ -O2 -I. fuelbench.cpp -L. -lminijs -Wl,-rpath,'$ORIGIN' -o fuelbench
\ No newline at end of file
@@ -0,0 +1,68 @@
+// arrbench: native Array-Kernels (ArrayRef::sum/indexOf/fill) gegen den interpretierten Weg
+//   arrbench [length=1000000] [reps=20]
+// Gleiches gepacktes DOUBLE-Array, einmal per Skript (js.run), einmal direkt ueber die ABI.
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "MiniJspp.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+template <typename Fn>
+static double usPerRep(int reps, Fn fn) {
+    fn(); // warm-up (Compile-Cache, Caches der CPU)
+    auto t0 = Clock::now();
+    for (int i = 0; i < reps; i++) fn();
+    auto t1 = Clock::now();
+    return std::chrono::duration<double, std::micro>(t1 - t0).count() / reps;
+}
+
+static void row(const char* name, double script, double native) {
+    std::printf("  %-8s %12.1f us %12.1f us %8.1fx\n", name, script, native, native > 0 ? script / native : 0.0);
+}
+
+int main(int argc, char** argv) {
+
+    int32_t length = argc > 1 ? (int32_t)std::atoi(argv[1]) : 1000000;
+    int reps = argc > 2 ? std::atoi(argv[2]) : 20;
+    if (length < 1) length = 1;
+    if (reps < 1) reps = 1;
+
+    minijspp::Engine js;
+    js.setCompileCacheCapacity(16); // nur die Ausfuehrung messen, nicht das Parsen
+
+    std::vector<double> values((size_t)length);
+    for (int32_t i = 0; i < length; i++) values[(size_t)i] = (double)(i % 1000) * 0.5;
+
+    minijspp::Array arr = js.createArray();
+    arr.reserve(length);
+    arr.pushNumbers(values);
+    js.declareCopy("arr", minijspp::Value::Handle(minijspp::Value::Kind::Array, arr.handle(), /*retain=*/true));
+
+    const double needle = -1.0; // nicht enthalten => voller Durchlauf
+    volatile double sinkD = 0.0;
+    volatile int32_t sinkI = 0;
+
+    double sumScript = usPerRep(reps, [&] { sinkD = minijspp::stringToNumber(js.run("arr.reduce((a,b)=>a+b)")); });
+    double sumNative = usPerRep(reps, [&] { sinkD = arr.sum(); });
+
+    double idxScript = usPerRep(reps, [&] { sinkI = (int32_t)minijspp::stringToNumber(js.run("arr.indexOf(-1)")); });
+    double idxNative = usPerRep(reps, [&] { sinkI = arr.indexOf(needle); });
+
+    double fillScript = usPerRep(reps, [&] { js.run("arr.fill(0.5)"); });
+    double fillNative = usPerRep(reps, [&] { arr.fill(0.5); });
+
+    static const char* kinds[] = { "INT32", "DOUBLE", "GENERIC" };
+    int kind = (int)arr.elementsKind();
+    std::printf("array length %d, %d reps, simd level: %s, elements kind: %s\n", length, reps, minijs_simd_level(), (kind >= 0 && kind <= 2) ? kinds[kind] : "?");
+    std::printf("  %-8s %15s %15s %9s\n", "", "script", "native", "speedup");
+    row("sum", sumScript, sumNative);
+    row("indexOf", idxScript, idxNative);
+    row("fill", fillScript, fillNative);
+    (void)sinkD;
+    (void)sinkI;
+    return 0;
+}
@@ -0,0 +1,71 @@
+// fuelbench: Kosten der Fuel-Zaehlung (setFuel(0) = unbegrenzt gegen grosses Budget)
+//   fuelbench [script.js] [reps=20]
+// Ohne Datei laeuft eine Schleife mit Arithmetik, Funktionsaufrufen und Array-Builtins.
+// Das Budget ist so gross, dass es nie erschoepft wird; gemessen wird nur das Zaehlen.
+
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "MiniJspp.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+static const char* kDefaultScript =
+    "function f(x) { return x * 2 + 1; }\n"
+    "let acc = 0;\n"
+    "for (let i = 0; i < 200000; i++) { acc = (acc + f(i)) % 1000003; }\n"
+    "let a = [];\n"
+    "for (let i = 0; i < 10000; i++) a.push(i);\n"
+    "acc + a.map(v => v + 1).reduce((s, v) => s + v, 0);\n";
+
+template <typename Fn>
+static double usPerRep(int reps, Fn fn) {
+    fn(); // warm-up
+    auto t0 = Clock::now();
+    for (int i = 0; i < reps; i++) fn();
+    auto t1 = Clock::now();
+    return std::chrono::duration<double, std::micro>(t1 - t0).count() / reps;
+}
+
+int main(int argc, char** argv) {
+
+    std::string code = kDefaultScript;
+    if (argc > 1) {
+        std::ifstream in(argv[1], std::ios::binary);
+        if (!in) {
+            std::fprintf(stderr, "cannot open %s\n", argv[1]);
+            return 1;
+        }
+        std::stringstream ss;
+        ss << in.rdbuf();
+        code = ss.str();
+    }
+    int reps = argc > 2 ? std::atoi(argv[2]) : 20;
+    if (reps < 1) reps = 1;
+
+    minijspp::Engine js;
+    js.setCompileCacheCapacity(4); // nur die Ausfuehrung messen, nicht das Parsen
+
+    const uint64_t budget = UINT64_MAX / 2;
+    std::string unlimitedResult, meteredResult;
+
+    js.setFuel(0);
+    double unlimited = usPerRep(reps, [&] { unlimitedResult = js.run(code); });
+
+    js.setFuel(budget);
+    double metered = usPerRep(reps, [&] { meteredResult = js.run(code); });
+    uint64_t consumed = js.fuelConsumed();
+    bool exhausted = minijs_last_error(js.raw()) == MINIJS_ERR_FUEL;
+    js.setFuel(0);
+
+    std::printf("%d reps, fuel per run: %llu\n", reps, (unsigned long long)consumed);
+    std::printf("  %-10s %12.1f us\n", "fuel 0", unlimited);
+    std::printf("  %-10s %12.1f us\n", "budget", metered);
+    std::printf("  overhead   %12.1f us (%+.1f%%)\n", metered - unlimited, unlimited > 0 ? (metered / unlimited - 1.0) * 100.0 : 0.0);
+    if (exhausted) std::printf("  warning: budget exhausted, timings not comparable\n");
+    if (unlimitedResult != meteredResult) std::printf("  warning: results differ (%s vs %s)\n", unlimitedResult.c_str(), meteredResult.c_str());
+    return 0;
+}
@@ -0,0 +1,225 @@
+// heapstat: wertet einen Heap-Snapshot aus (Format siehe minijs_heap_snapshot in Api.h)
+//   heapstat <file.heap> [top=20]
+// Gibt Summen pro Kind und die Objekte mit der groessten retained size aus
+// (Dominator-Baum, Cooper/Harvey/Kennedy).
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <map>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstdio>
+
+struct Node {
+    uint64_t id;
+    std::string kind;
+    uint64_t self;
+    std::string name;
+};
+
+static std::vector<std::string> splitTabs(const std::string& line) {
+    std::vector<std::string> f;
+    size_t start = 0;
+    for (;;) {
+        size_t t = line.find('\t', start);
+        if (t == std::string::npos) {
+            f.push_back(line.substr(start));
+            return f;
+        }
+        f.push_back(line.substr(start, t - start));
+        start = t + 1;
+    }
+}
+
+static std::string unescape(const std::string& s) {
+    std::string r;
+    for (size_t i = 0; i < s.size(); i++) {
+        if (s[i] == '\\' && i + 1 < s.size()) {
+            char e = s[++i];
+            if (e == 't') r.push_back('\t');
+            else if (e == 'n') r.push_back('\n');
+            else r.push_back(e);
+        }
+        else {
+            r.push_back(s[i]);
+        }
+    }
+    return r;
+}
+
+static std::string shortName(const Node& n) {
+    std::string s = n.name;
+    for (char& c : s) {
+        if (c == '\n' || c == '\t') c = ' ';
+    }
+    if (s.size() > 60) s = s.substr(0, 57) + "...";
+    return s;
+}
+
+int main(int argc, char** argv) {
+
+    if (argc < 2) {
+        std::cout << "usage: " << argv[0] << " <file.heap> [top=20]\n";
+        return 1;
+    }
+    size_t top = argc > 2 ? (size_t)std::atoi(argv[2]) : 20;
+
+    std::ifstream in(argv[1], std::ios::binary);
+    if (!in) {
+        std::cerr << "cannot open " << argv[1] << "\n";
+        return 1;
+    }
+
+    // Index 0 = virtueller Super-Root, der alle GC-Roots haelt
+    std::vector<Node> nodes(1, Node{ 0, "(roots)", 0, "" });
+    std::unordered_map<uint64_t, uint32_t> index;
+    std::vector<std::vector<uint32_t>> succ(1);
+
+    std::string line;
+    if (!std::getline(in, line) || line.rfind("MINIJS-HEAP\t", 0) != 0) {
+        std::cerr << "not a minijs heap snapshot\n";
+        return 1;
+    }
+    if (line != "MINIJS-HEAP\t1") {
+        std::cerr << "unsupported snapshot version: " << line.substr(12) << "\n";
+        return 1;
+    }
+
+    size_t edges = 0;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty()) continue;
+        std::vector<std::string> f = splitTabs(line);
+
+        if (f[0] == "N" && f.size() >= 4) {
+            Node n{ std::strtoull(f[1].c_str(), nullptr, 10), f[2], std::strtoull(f[3].c_str(), nullptr, 10), f.size() > 4 ? unescape(f[4]) : "" };
+            index[n.id] = (uint32_t)nodes.size();
+            nodes.push_back(std::move(n));
+            succ.emplace_back();
+        }
+        else if (f[0] == "E" && f.size() >= 4) {
+            if (f[3] == "weak") continue;
+            auto a = index.find(std::strtoull(f[1].c_str(), nullptr, 10));
+            auto b = index.find(std::strtoull(f[2].c_str(), nullptr, 10));
+            if (a == index.end() || b == index.end()) continue;
+            succ[a->second].push_back(b->second);
+            edges++;
+        }
+        else if (f[0] == "R" && f.size() >= 2) {
+            auto a = index.find(std::strtoull(f[1].c_str(), nullptr, 10));
+            if (a != index.end()) succ[0].push_back(a->second);
+        }
+    }
+
+    const uint32_t n = (uint32_t)nodes.size();
+    const uint32_t UNDEF = 0xFFFFFFFFu;
+
+    // Postorder per iterativer DFS vom Super-Root
+    std::vector<uint32_t> post;
+    std::vector<uint32_t> postIndex(n, UNDEF);
+    {
+        std::vector<uint8_t> seen(n, 0);
+        std::vector<std::pair<uint32_t, size_t>> stack;
+        stack.push_back({ 0, 0 });
+        seen[0] = 1;
+        while (!stack.empty()) {
+            auto& top2 = stack.back();
+            if (top2.second < succ[top2.first].size()) {
+                uint32_t s = succ[top2.first][top2.second++];
+                if (!seen[s]) {
+                    seen[s] = 1;
+                    stack.push_back({ s, 0 });
+                }
+            }
+            else {
+                postIndex[top2.first] = (uint32_t)post.size();
+                post.push_back(top2.first);
+                stack.pop_back();
+            }
+        }
+    }
+
+    std::vector<std::vector<uint32_t>> pred(n);
+    for (uint32_t a = 0; a < n; a++) {
+        if (postIndex[a] == UNDEF) continue;
+        for (uint32_t b : succ[a]) pred[b].push_back(a);
+    }
+
+    // Dominatoren (Cooper/Harvey/Kennedy), in umgekehrter Postorder
+    std::vector<uint32_t> idom(n, UNDEF);
+    idom[0] = 0;
+    auto intersect = [&](uint32_t a, uint32_t b) {
+        while (a != b) {
+            while (postIndex[a] < postIndex[b]) a = idom[a];
+            while (postIndex[b] < postIndex[a]) b = idom[b];
+        }
+        return a;
+    };
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (size_t i = post.size(); i-- > 0;) {
+            uint32_t v = post[i];
+            if (v == 0) continue;
+            uint32_t d = UNDEF;
+            for (uint32_t p : pred[v]) {
+                if (idom[p] == UNDEF) continue;
+                d = (d == UNDEF) ? p : intersect(p, d);
+            }
+            if (d != UNDEF && idom[v] != d) {
+                idom[v] = d;
+                changed = true;
+            }
+        }
+    }
+
+    // retained = self + retained aller dominierten Knoten (Postorder: Kinder zuerst)
+    std::vector<uint64_t> retained(n, 0);
+    for (uint32_t v : post) {
+        retained[v] += nodes[v].self;
+        if (v != 0) retained[idom[v]] += retained[v];
+    }
+
+    // Summen pro Kind
+    struct KindTotal { uint64_t count = 0, self = 0; };
+    std::map<std::string, KindTotal> kinds;
+    uint64_t total = 0, unreachable = 0;
+    for (uint32_t v = 1; v < n; v++) {
+        kinds[nodes[v].kind].count++;
+        kinds[nodes[v].kind].self += nodes[v].self;
+        total += nodes[v].self;
+        if (postIndex[v] == UNDEF) unreachable += nodes[v].self;
+    }
+
+    std::cout << "nodes: " << (n - 1) << "  edges: " << edges << "  bytes: " << total;
+    if (unreachable) std::cout << "  (not reachable from roots: " << unreachable << ")";
+    std::cout << "\n\n";
+
+    std::vector<std::pair<std::string, KindTotal>> byKind(kinds.begin(), kinds.end());
+    std::sort(byKind.begin(), byKind.end(), [](const auto& a, const auto& b) { return a.second.self > b.second.self; });
+    std::cout << "per kind:\n";
+    for (const auto& k : byKind) {
+        std::printf("  %-10s %10llu objects %14llu bytes\n", k.first.c_str(), (unsigned long long)k.second.count, (unsigned long long)k.second.self);
+    }
+
+    std::vector<uint32_t> order;
+    for (uint32_t v = 1; v < n; v++) {
+        if (postIndex[v] != UNDEF) order.push_back(v);
+    }
+    size_t shown = std::min(top, order.size());
+    std::partial_sort(order.begin(), order.begin() + shown, order.end(), [&](uint32_t a, uint32_t b) { return retained[a] > retained[b]; });
+
+    std::cout << "\ntop retainers (retained bytes, self bytes, kind, name <- held by):\n";
+    for (size_t i = 0; i < shown; i++) {
+        uint32_t v = order[i];
+        const Node& nd = nodes[v];
+        std::printf("  %14llu %10llu  %-8s %s", (unsigned long long)retained[v], (unsigned long long)nd.self, nd.kind.c_str(), shortName(nd).c_str());
+        uint32_t d = idom[v];
+        if (d == 0) std::printf("  <- (root)\n");
+        else std::printf("  <- %s %s\n", nodes[d].kind.c_str(), shortName(nodes[d]).c_str());
+    }
+    return 0;
+}
@@ -1,6 +1,16 @@
+// Beispiel-Host. Nutzt die erweiterte API (Fast-Functions, Stats, GC, Profiler,
+// Heap-Snapshot) und linkt daher nur gegen eine libminijs, die diese Symbole
+// exportiert. Nur-Basis-Hosts (run/register/create*) linken weiterhin gegen die
+// aeltere Bibliothek.
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include "MiniJspp.hpp"
 
 static std::string readFile(const char* path) {
@@ -10,14 +20,193 @@ static std::string readFile(const char* path) {
     return ss.str();
 }
 
+static double hostHypot(double a, double b) {
+    return std::sqrt(a * a + b * b);
+}
+
+// ------------------------------------------------------------
+// Metriken im Prometheus-Textformat (Standard, z.B. fuer den textfile-Collector
+// des node exporters) oder als OpenMetrics (--metrics-format openmetrics)
+// ------------------------------------------------------------
+
+enum class MetricsFormat { Prometheus, OpenMetrics };
+
+static std::string escapeLabel(const std::string& s) {
+    std::string r;
+    for (char c : s) {
+        if (c == '\\') r += "\\\\";
+        else if (c == '"') r += "\\\"";
+        else if (c == '\n') r += "\\n";
+        else r.push_back(c);
+    }
+    return r;
+}
+
+// Kopfzeilen einer Familie. Prometheus-Text: TYPE/HELP tragen den vollen
+// Sample-Namen (mit _total), sonst gilt der Counter als untyped.
+// OpenMetrics: Familienname ohne _total.
+static void family(std::ostream& o, MetricsFormat fmt, const char* name, const char* type, const char* help) {
+    std::string n = name;
+    if (fmt == MetricsFormat::Prometheus && std::string(type) == "counter") n += "_total";
+    o << "# TYPE " << n << " " << type << "\n";
+    o << "# HELP " << n << " " << help << "\n";
+}
+
+static void metric(std::ostream& o, MetricsFormat fmt, const char* name, const char* type, const char* help, double value) {
+    bool counter = std::string(type) == "counter";
+    family(o, fmt, name, type, help);
+    o << name << (counter ? "_total " : " ") << minijspp::numberToString(value) << "\n";
+}
+
+static void writeMetrics(const minijspp::Engine& js, std::ostream& o, MetricsFormat fmt) {
+    minijspp::Engine::EngineStats st = js.stats();
+    metric(o, fmt, "minijs_runs", "counter", "Script runs.", (double)st.run_count);
+    metric(o, fmt, "minijs_script_cpu_seconds", "counter", "CPU time spent in script, excluding native callbacks.", st.script_cpu_ns / 1e9);
+    metric(o, fmt, "minijs_native_cpu_seconds", "counter", "CPU time spent in native callbacks.", st.native_cpu_ns / 1e9);
+    metric(o, fmt, "minijs_native_calls", "counter", "Native callback invocations.", (double)st.native_calls);
+    metric(o, fmt, "minijs_allocated_bytes", "counter", "Bytes allocated by the script heap.", (double)st.bytes_allocated);
+    metric(o, fmt, "minijs_heap_live_bytes", "gauge", "Current script heap size.", (double)st.bytes_live);
+    metric(o, fmt, "minijs_gc_collections", "counter", "Garbage collections.", (double)st.gc_count);
+    metric(o, fmt, "minijs_gc_seconds", "counter", "Time spent in garbage collection.", st.gc_ns / 1e9);
+
+    minijspp::Engine::GcStats gc = js.gcStats();
+    metric(o, fmt, "minijs_gc_minor_collections", "counter", "Minor (nursery) collections.", (double)gc.minor_count);
+    metric(o, fmt, "minijs_gc_minor_seconds", "counter", "Time spent in minor collections.", gc.minor_ns / 1e9);
+    metric(o, fmt, "minijs_gc_minor_max_pause_seconds", "gauge", "Longest minor collection pause.", gc.minor_max_pause_ns / 1e9);
+    metric(o, fmt, "minijs_gc_major_collections", "counter", "Major (old space) collections.", (double)gc.major_count);
+    metric(o, fmt, "minijs_gc_major_seconds", "counter", "Time spent in major collections.", gc.major_ns / 1e9);
+    metric(o, fmt, "minijs_gc_major_max_pause_seconds", "gauge", "Longest major collection pause.", gc.major_max_pause_ns / 1e9);
+    metric(o, fmt, "minijs_gc_promoted_bytes", "counter", "Bytes promoted from the nursery to the old space.", (double)gc.bytes_promoted);
+    metric(o, fmt, "minijs_gc_young_live_bytes", "gauge", "Live nursery bytes after the last minor collection.", (double)gc.young_live_bytes);
+    metric(o, fmt, "minijs_gc_old_live_bytes", "gauge", "Live old space bytes after the last major collection.", (double)gc.old_live_bytes);
+
+    minijspp::Engine::CompileCacheStats cc = js.compileCacheStats();
+    metric(o, fmt, "minijs_compile_cache_hits", "counter", "Engine::run compile cache hits.", (double)cc.hits);
+    metric(o, fmt, "minijs_compile_cache_misses", "counter", "Engine::run compile cache misses.", (double)cc.misses);
+    metric(o, fmt, "minijs_compile_cache_failures", "counter", "Engine::run sources that failed to compile.", (double)cc.failures);
+    metric(o, fmt, "minijs_compile_cache_evictions", "counter", "Engine::run compile cache evictions.", (double)cc.evictions);
+    metric(o, fmt, "minijs_compile_cache_entries", "gauge", "Compiled scripts held by the cache.", (double)cc.entries);
+
+    minijspp::Engine::RegexCacheStats rc = js.regexCacheStats();
+    metric(o, fmt, "minijs_regex_cache_hits", "counter", "Regex cache hits.", (double)rc.hits);
+    metric(o, fmt, "minijs_regex_cache_misses", "counter", "Regex compilations.", (double)rc.misses);
+    metric(o, fmt, "minijs_regex_cache_evictions", "counter", "Regex cache evictions.", (double)rc.evictions);
+
+    std::vector<minijspp::Engine::BindingStats> bs = js.bindingStats();
+    family(o, fmt, "minijs_binding_calls", "counter", "Calls per native binding (fast bindings: direct + fallback).");
+    for (const auto& b : bs) o << "minijs_binding_calls_total{binding=\"" << escapeLabel(b.name) << "\"} " << b.calls << "\n";
+    family(o, fmt, "minijs_binding_errors", "counter", "Native bindings that threw.");
+    for (const auto& b : bs) o << "minijs_binding_errors_total{binding=\"" << escapeLabel(b.name) << "\"} " << b.errors << "\n";
+    family(o, fmt, "minijs_binding_fast_calls", "counter", "Direct (unmarshaled) calls of fast numeric bindings.");
+    for (const auto& b : bs) {
+        if (b.fast) o << "minijs_binding_fast_calls_total{binding=\"" << escapeLabel(b.name) << "\"} " << b.fastCalls << "\n";
+    }
+    // Fast-Bindings ohne Zeitmessung (direkte Aufrufe laufen am Trampolin vorbei)
+    family(o, fmt, "minijs_binding_seconds", "counter", "Wall time per native binding (fast bindings excluded).");
+    for (const auto& b : bs) {
+        if (!b.fast) o << "minijs_binding_seconds_total{binding=\"" << escapeLabel(b.name) << "\"} " << minijspp::numberToString(b.nanos / 1e9) << "\n";
+    }
+    if (fmt == MetricsFormat::OpenMetrics) o << "# EOF\n";
+}
+
+// Ueber eine Temp-Datei + rename, damit der Exporter nie eine halbe Datei liest
+static void writeMetricsFile(const minijspp::Engine& js, const std::string& path, MetricsFormat fmt) {
+    std::string tmp = path + ".tmp";
+    {
+        std::ofstream f(tmp, std::ios::binary | std::ios::trunc);
+        if (!f) {
+            std::cerr << "metrics: cannot write " << tmp << "\n";
+            return;
+        }
+        writeMetrics(js, f, fmt);
+    }
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        // Windows: rename ersetzt keine bestehende Datei
+        std::remove(path.c_str());
+        if (std::rename(tmp.c_str(), path.c_str()) != 0) std::cerr << "metrics: cannot rename " << tmp << "\n";
+    }
+}
+
+// Schreibt alle intervalSec Sekunden, solange das Objekt lebt
+class MetricsWriter {
+public:
+    MetricsWriter(const minijspp::Engine& js, std::string path, double intervalSec, MetricsFormat fmt)
+        : _js(js), _path(std::move(path)), _interval(intervalSec), _fmt(fmt), _stop(false) {
+        if (_interval > 0) _thread = std::thread([this] { loop(); });
+    }
+
+    ~MetricsWriter() {
+        {
+            std::lock_guard<std::mutex> lock(_m);
+            _stop = true;
+        }
+        _cv.notify_all();
+        if (_thread.joinable()) _thread.join();
+        writeMetricsFile(_js, _path, _fmt); // immer einmal am Ende
+    }
+
+private:
+    void loop() {
+        std::unique_lock<std::mutex> lock(_m);
+        while (!_stop) {
+            if (_cv.wait_for(lock, std::chrono::duration<double>(_interval), [this] { return _stop; })) break;
+            writeMetricsFile(_js, _path, _fmt);
+        }
+    }
+
+    const minijspp::Engine& _js;
+    std::string _path;
+    double _interval;
+    MetricsFormat _fmt;
+    bool _stop;
+    std::mutex _m;
+    std::condition_variable _cv;
+    std::thread _thread;
+};
+
 int main(int argc, char** argv) {
 
-    if (argc < 2) {
-        std::cout << "usage: " << argv[0] << " <script.js>\n";
+    std::string metricsPath;
+    double metricsInterval = 0.0;
+    MetricsFormat metricsFormat = MetricsFormat::Prometheus;
+    std::string allocProfilePath;
+    std::string heapSnapshotPath;
+    uint32_t nurseryBytes = 0;
+    const char* scriptPath = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        if (a == "--metrics" && i + 1 < argc) metricsPath = argv[++i];
+        else if (a == "--metrics-interval" && i + 1 < argc) metricsInterval = std::atof(argv[++i]);
+        else if (a == "--metrics-format" && i + 1 < argc) {
+            std::string v = argv[++i];
+            if (v == "openmetrics") metricsFormat = MetricsFormat::OpenMetrics;
+            else if (v == "prometheus") metricsFormat = MetricsFormat::Prometheus;
+            else {
+                std::cerr << "unknown --metrics-format " << v << " (prometheus|openmetrics)\n";
+                return 1;
+            }
+        }
+        else if (a == "--alloc-profile" && i + 1 < argc) allocProfilePath = argv[++i];
+        else if (a == "--heap-snapshot" && i + 1 < argc) heapSnapshotPath = argv[++i];
+        else if (a == "--nursery" && i + 1 < argc) nurseryBytes = (uint32_t)std::strtoul(argv[++i], nullptr, 10) * 1024;
+        else if (!scriptPath) scriptPath = argv[i];
+    }
+
+    if (!scriptPath) {
+        std::cout << "usage: " << argv[0] << " [--metrics <file.prom>] [--metrics-interval <sec>] [--metrics-format prometheus|openmetrics] [--alloc-profile <file.folded>] [--heap-snapshot <file.heap>] [--nursery <KiB>] <script.js>\n";
         return 1;
     }
 
     minijspp::Engine js;
+    js.setResultLength(true); // Ergebnislaenge direkt von der Runtime (minijs_run_n)
+
+    // Nursery-Groesse vor dem ersten Lauf (0 = Default der Runtime)
+    if (nurseryBytes) {
+        minijspp::Engine::GcConfig gc{};
+        gc.nursery_bytes = nurseryBytes;
+        js.configureGc(gc);
+    }
 
     // 1) globale Funktion hostAdd(a,b)
     js.registerFunction("hostAdd", [](const std::vector<minijspp::Value>& args, const minijspp::Value&) {
@@ -26,31 +215,56 @@ int main(int argc, char** argv) {
         return minijspp::Value::Number(a + b);
         });
 
+    // 1b) reine Zahlenfunktion => Fast-Path ohne Marshaling
+    //     (Fallback mit JS-ToNumber: fehlendes Argument => NaN, "3" => 3)
+    js.registerFastFunction("hostHypot", &hostHypot);
+
     // 2) Klasse Counter: constructor(v){ this.x=v }  inc(){ this.x++; return this.x }
     auto counter = js.createClass("Counter");
 
     counter.addMethod("constructor", js.createFunction([&js](const std::vector<minijspp::Value>& args, const minijspp::Value& thisVal) {
-        // thisVal ist ein Objekt
-        minijspp::Object self(minijspp::Value::Handle(minijspp::Value::Kind::Object, thisVal.handle(), /*retain*/true));
+        // thisVal ist ein Objekt (geliehen, die Runtime haelt es waehrend des Aufrufs am Leben)
+        minijspp::ObjectRef self(thisVal.handle());
         double v = args.size() > 0 ? args[0].toNumber() : 0.0;
         self.set(js, "x", minijspp::Value::Number(v));
         return minijspp::Value::Null();
-        }));
+        }, "Counter.constructor"));
 
     counter.addMethod("inc", js.createFunction([&js](const std::vector<minijspp::Value>&, const minijspp::Value& thisVal) {
-        minijspp::Object self(minijspp::Value::Handle(minijspp::Value::Kind::Object, thisVal.handle(), /*retain*/true));
+        minijspp::ObjectRef self(thisVal.handle());
         double x = self.get("x").toNumber();
         x += 1.0;
         self.set(js, "x", minijspp::Value::Number(x));
         return minijspp::Value::Number(x);
-        }));
+        }, "Counter.inc"));
 
     // ins Global-Scope stellen (ownership geht an Runtime)
     js.declareMove("Counter", counter.toValueMove());
 
-    std::string code = readFile(argv[1]);
+    std::unique_ptr<MetricsWriter> metrics;
+    if (!metricsPath.empty()) {
+        js.setBindingTiming(true);
+        metrics.reset(new MetricsWriter(js, metricsPath, metricsInterval, metricsFormat));
+    }
+
+    if (!allocProfilePath.empty()) js.startAllocationProfile();
+
+    std::string code = readFile(scriptPath);
     std::string ret = js.run(code);
 
+    // Collapsed Stacks (flamegraph.pl / speedscope)
+    if (!allocProfilePath.empty()) {
+        std::ofstream f(allocProfilePath, std::ios::binary | std::ios::trunc);
+        js.stopAllocationProfile(minijspp::Engine::ProfileFormat::Collapsed, [&f](const char* data, size_t len) { f.write(data, (std::streamsize)len); });
+    }
+
+    // Auswertung mit: heapstat <file.heap>
+    if (!heapSnapshotPath.empty()) {
+        std::ofstream f(heapSnapshotPath, std::ios::binary | std::ios::trunc);
+        js.heapSnapshot([&f](const char* data, size_t len) { f.write(data, (std::streamsize)len); });
+    }
+
     std::cout << "minijs_run returned: " << ret << "\n";
+    metrics.reset(); // letzter Schreibvorgang, solange die Engine noch lebt
     return 0;
 }
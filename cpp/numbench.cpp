@@ -0,0 +1,76 @@
+// numbench: Microbenchmark fuer numberToString / stringToNumber (String(n) / Number(s))
+//   numbench [count=1000000]
+// Vergleicht mit snprintf("%.17g") / strtod und prueft nebenbei den Round-Trip.
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "MiniJspp.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+static double nsPerOp(Clock::time_point t0, Clock::time_point t1, size_t n) {
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / (double)n;
+}
+
+int main(int argc, char** argv) {
+
+    size_t count = argc > 1 ? (size_t)std::strtoull(argv[1], nullptr, 10) : 1000000;
+    if (count == 0) count = 1;
+
+    // Mischung wie in typischen Skripten: kleine Ganzzahlen, Dezimalbrueche, beliebige Doubles
+    std::mt19937_64 rng(42);
+    std::vector<double> values(count);
+    for (size_t i = 0; i < count; i++) {
+        switch (i % 3) {
+        case 0:  values[i] = (double)(rng() % 100000); break;
+        case 1:  values[i] = (double)(rng() % 1000000) / 100.0; break;
+        default: {
+            uint64_t bits = rng();
+            std::memcpy(&values[i], &bits, sizeof(bits));
+            if (!std::isfinite(values[i])) values[i] = 0.5;
+        }
+        }
+    }
+
+    std::vector<std::string> strs(count);
+    size_t sink = 0;
+
+    // double -> string
+    auto t0 = Clock::now();
+    for (size_t i = 0; i < count; i++) strs[i] = minijspp::numberToString(values[i]);
+    auto t1 = Clock::now();
+
+    char buf[32];
+    auto t2 = Clock::now();
+    for (size_t i = 0; i < count; i++) sink += (size_t)std::snprintf(buf, sizeof(buf), "%.17g", values[i]);
+    auto t3 = Clock::now();
+
+    // string -> double
+    double acc = 0.0;
+    size_t mismatches = 0;
+    auto t4 = Clock::now();
+    for (size_t i = 0; i < count; i++) {
+        double v = minijspp::stringToNumber(strs[i]);
+        if (v != values[i]) mismatches++;
+        acc += v;
+    }
+    auto t5 = Clock::now();
+
+    auto t6 = Clock::now();
+    for (size_t i = 0; i < count; i++) acc += std::strtod(strs[i].c_str(), nullptr);
+    auto t7 = Clock::now();
+
+    std::printf("%zu values\n", count);
+    std::printf("  numberToString   %8.1f ns/op\n", nsPerOp(t0, t1, count));
+    std::printf("  snprintf %%.17g   %8.1f ns/op\n", nsPerOp(t2, t3, count));
+    std::printf("  stringToNumber   %8.1f ns/op\n", nsPerOp(t4, t5, count));
+    std::printf("  strtod           %8.1f ns/op\n", nsPerOp(t6, t7, count));
+    std::printf("round-trip mismatches: %zu\n", mismatches);
+    if (sink == 0 && acc == 0.0) std::printf("\n"); // Ergebnisse benutzen, damit nichts wegoptimiert wird
+    return mismatches == 0 ? 0 : 1;
+}